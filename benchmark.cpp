@@ -0,0 +1,96 @@
+#include <iostream>
+#include <mutex>
+
+#include "benchmark/compare.hpp"
+#include "benchmark/options.hpp"
+#include "benchmark/perf_counters.hpp"
+#include "benchmark/report.hpp"
+#include "benchmark/workloads.hpp"
+
+#include "lock.hpp"
+#include "id_aware_lock.hpp"
+#include "mutex.hpp"
+#include "pthread_mutex.hpp"
+#include "semaphore.hpp"
+#include "posix_semaphore.hpp"
+#include "lightweight_semphore.hpp"
+
+#if __cplusplus >= 202002L
+#include "atomic_lock.hpp"
+#include "atomic_semaphore.hpp"
+#include "std_semaphore.hpp"
+#endif
+
+//IdAwareLock needs a (non-zero) id per thread
+template <>
+struct bench::LockAdapter<IdAwareLock>
+{
+    static void lock(IdAwareLock &lock, uint32_t id)
+    {
+        lock.lock(id);
+    }
+
+    static void unlock(IdAwareLock &lock, uint32_t id)
+    {
+        lock.unlock(id);
+    }
+};
+
+using LightSemaphore = LightweightSemaphore<Semaphore>;
+using LightPosixSemaphore = LightweightSemaphore<PosixSemaphore>;
+
+int main(int argc, char **argv)
+{
+    bench::Options options;
+    if (!options.parse(argc, argv))
+    {
+        return 1;
+    }
+
+    if (options.perf)
+    {
+        auto &counters = bench::PerfCounters::instance();
+        if (!counters.open())
+        {
+            std::cerr << "no performance counters available (check /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+        }
+        for (auto &name : counters.unavailable())
+        {
+            std::cerr << "counter " << name << " not available" << std::endl;
+        }
+    }
+
+    std::vector<bench::Result> results;
+    {
+        bench::Report report(options.format);
+
+        //locks, baselines first
+        bench::runAll(report, "std::mutex", "lock", options, bench::runLock<std::mutex>);
+        bench::runAll(report, "PthreadMutex", "lock", options, bench::runLock<PthreadMutex>);
+        bench::runAll(report, "Lock", "lock", options, bench::runLock<Lock>);
+        bench::runAll(report, "Mutex", "lock", options, bench::runLock<Mutex>);
+        bench::runAll(report, "IdAwareLock", "lock", options, bench::runLock<IdAwareLock>);
+#if __cplusplus >= 202002L
+        bench::runAll(report, "AtomicLock", "lock", options, bench::runLock<AtomicLock>);
+#endif
+
+        //semaphores, baseline first
+        bench::runAll(report, "PosixSemaphore", "semaphore", options, bench::runSemaphore<PosixSemaphore>);
+        bench::runAll(report, "Semaphore", "semaphore", options, bench::runSemaphore<Semaphore>);
+        bench::runAll(report, "LightSemaphore", "semaphore", options, bench::runSemaphore<LightSemaphore>);
+        bench::runAll(report, "LightPosixSemaphore", "semaphore", options, bench::runSemaphore<LightPosixSemaphore>);
+#if __cplusplus >= 202002L
+        bench::runAll(report, "AtomicSemaphore", "semaphore", options, bench::runSemaphore<AtomicSemaphore>);
+        bench::runAll(report, "StdSemaphore", "semaphore", options, bench::runSemaphore<StdSemaphore>);
+#endif
+
+        results = report.results();
+    }
+
+    if (!options.compare.empty())
+    {
+        bench::printComparison(results, options.compare[0], options.compare[1]);
+    }
+
+    return 0;
+}
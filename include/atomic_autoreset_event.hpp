@@ -0,0 +1,57 @@
+#pragma once
+
+#if __cplusplus < 202002L
+#error "atomic_autoreset_event.hpp requires C++20 (std::atomic::wait/notify)"
+#endif
+
+#include "atomic_semaphore.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+//AutoResetEvent on top of AtomicSemaphore, i.e. without any direct futex usage
+class AtomicAutoResetEvent
+{
+public:
+    AtomicAutoResetEvent(int64_t initialCount = 0) : m_count(initialCount)
+    {
+        if (m_count > 1)
+        {
+            m_count = 1;
+        }
+    }
+
+    void signal()
+    {
+        auto count = m_count.load(std::memory_order_relaxed);
+        do
+        {
+            auto newCount = count < 1 ? count + 1 : 1;
+            if (m_count.compare_exchange_weak(count, newCount, std::memory_order_release, std::memory_order_relaxed))
+            {
+                break;
+            }
+
+        } while (true);
+
+        if (count < 0)
+        {
+            m_semaphore.post();
+        }
+    }
+
+    void wait()
+    {
+        auto count = m_count.fetch_sub(1, std::memory_order_acquire);
+
+        if (count < 1)
+        {
+            m_semaphore.wait();
+        }
+    }
+
+private:
+    //same meaning as in AutoResetEvent: 1 signalled, 0 not signalled, -n n threads waiting
+    std::atomic<int64_t> m_count;
+    AtomicSemaphore m_semaphore;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#if __cplusplus < 202002L
+#error "atomic_lock.hpp requires C++20 (std::atomic::wait/notify)"
+#endif
+
+#include "instrumentation/probes.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+//same three state algorithm as Lock, but sleeping uses std::atomic<int32_t>::wait/notify_one instead of a raw futex
+class AtomicLock
+{
+private:
+    enum State : int32_t
+    {
+        UNLOCKED = 0,
+        LOCKED = 1,
+        CONTESTED = 2
+    };
+
+    const uint32_t MAX_SPINNING_ACQUIRE_ITERATIONS{1000};
+
+    std::atomic<int32_t> state{UNLOCKED};
+
+    int32_t compareExchangeState(int32_t expected, int32_t desired)
+    {
+        state.compare_exchange_strong(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire);
+        return expected;
+    }
+
+    int32_t exchangeState(int32_t desired)
+    {
+        return state.exchange(desired, std::memory_order_acq_rel);
+    }
+
+    void sleepIfContested()
+    {
+        auto parkToken = instrumentation::onParking(this);
+        state.wait(CONTESTED, std::memory_order_acquire);
+        instrumentation::onUnparked(this, parkToken);
+    }
+
+public:
+    AtomicLock(uint32_t maxSpinIterations = 1)
+        : MAX_SPINNING_ACQUIRE_ITERATIONS(maxSpinIterations > 0 ? maxSpinIterations : 1)
+    {
+    }
+
+    AtomicLock(const AtomicLock &) = delete;
+    AtomicLock(AtomicLock &&) = delete;
+
+    void lock()
+    {
+        bool slept = false;
+
+        for (uint32_t i = 0; i < MAX_SPINNING_ACQUIRE_ITERATIONS; ++i)
+        {
+            auto knownState = compareExchangeState(UNLOCKED, LOCKED);
+            if (knownState == UNLOCKED)
+            {
+                instrumentation::onAcquired(this, i == 0 ? instrumentation::AcquirePath::FAST : instrumentation::AcquirePath::SPIN);
+                return;
+            }
+            else if (knownState == CONTESTED)
+            {
+                sleepIfContested();
+                slept = true;
+                break;
+            }
+        }
+
+        while (exchangeState(CONTESTED) != UNLOCKED)
+        {
+            if (slept)
+            {
+                instrumentation::onSpuriousWakeup(this);
+            }
+            sleepIfContested();
+            slept = true;
+        }
+
+        instrumentation::onAcquired(this, slept ? instrumentation::AcquirePath::SLOW : instrumentation::AcquirePath::SPIN);
+    }
+
+    void unlock()
+    {
+        instrumentation::onReleased(this);
+        if (exchangeState(UNLOCKED) == CONTESTED)
+        {
+            instrumentation::onWaking(this);
+            state.notify_one();
+        }
+    }
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#if __cplusplus < 202002L
+#error "atomic_semaphore.hpp requires C++20 (std::atomic::wait/notify)"
+#endif
+
+#include "instrumentation/probes.hpp"
+
+#include <atomic>
+#include <limits>
+#include <cstddef>
+
+//same algorithm as Semaphore, but the futex syscalls are replaced by std::atomic<int>::wait/notify
+//intended as a drop-in alternative to compare the hand-rolled futex implementation against the standard library
+//(which, on linux, uses a futex as well but may add its own waiter bookkeeping and spinning)
+class AtomicSemaphore
+{
+public:
+    AtomicSemaphore(int initialValue = 0) : value{initialValue}
+    {
+        if (value < 0)
+        {
+            value = 0;
+        }
+    }
+
+    AtomicSemaphore(const AtomicSemaphore &) = delete;
+    AtomicSemaphore(AtomicSemaphore &&) = delete;
+
+    bool tryWait()
+    {
+        auto oldValue = value.load(std::memory_order_relaxed);
+
+        do
+        {
+            if (oldValue == 0)
+            {
+                return false;
+            }
+        } while (!value.compare_exchange_strong(oldValue, oldValue - 1, std::memory_order_acquire, std::memory_order_relaxed));
+
+        return true;
+    }
+
+    void wait()
+    {
+        if (tryWait())
+        {
+            instrumentation::onAcquired(this, instrumentation::AcquirePath::FAST);
+            return;
+        }
+
+        waitCount.fetch_add(1, std::memory_order_acq_rel);
+
+        do
+        {
+            //returns immediately if value is not 0 anymore (like FUTEX_WAIT)
+            auto parkToken = instrumentation::onParking(this);
+            value.wait(0, std::memory_order_acquire);
+            instrumentation::onUnparked(this, parkToken);
+            if (tryWait())
+            {
+                break;
+            }
+            instrumentation::onSpuriousWakeup(this);
+        } while (true);
+
+        waitCount.fetch_sub(1, std::memory_order_acq_rel);
+        instrumentation::onAcquired(this, instrumentation::AcquirePath::SLOW);
+    }
+
+    size_t post(size_t increment = 1)
+    {
+        size_t overflowBound = MAX_VALUE - increment;
+
+        auto oldValue = value.load(std::memory_order_relaxed);
+
+        do
+        {
+            if (oldValue > static_cast<int>(overflowBound))
+            {
+                if (oldValue == MAX_VALUE)
+                {
+                    return 0;
+                }
+
+                if (value.compare_exchange_strong(oldValue, MAX_VALUE, std::memory_order_release, std::memory_order_relaxed))
+                {
+                    increment = MAX_VALUE - oldValue;
+                    break;
+                }
+            }
+            else
+            {
+                if (value.compare_exchange_strong(oldValue, oldValue + static_cast<int>(increment)))
+                {
+                    break;
+                }
+            }
+        } while (true);
+
+        instrumentation::onSignal(this);
+        if (waitCount.load(std::memory_order_acquire) != 0)
+        {
+            instrumentation::onWaking(this);
+            //there is no notify_n, so we have to wake everyone if we incremented by more than one
+            if (increment == 1)
+            {
+                value.notify_one();
+            }
+            else
+            {
+                value.notify_all();
+            }
+        }
+        return increment;
+    }
+
+private:
+    std::atomic<int> value;
+    std::atomic<int> waitCount{0};
+
+    static constexpr int MAX_VALUE = std::numeric_limits<int>::max();
+};
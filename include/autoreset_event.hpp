@@ -1,7 +1,9 @@
 #pragma once
 
 #include "semaphore.hpp"
+#include "instrumentation/probes.hpp"
 #include <atomic>
+#include <chrono>
 
 class AutoResetEvent
 {
@@ -16,6 +18,7 @@ public:
 
     void signal()
     {
+        instrumentation::onSignal(this);
         auto count = m_count.load(std::memory_order_relaxed);
         do
         {
@@ -43,11 +46,54 @@ public:
         if (count < 1)
         {
             //otherwise <= 0 and we wait
+            instrumentation::onWaitBegin(this);
             m_semaphore.wait();
+            instrumentation::onWaitEnd(this);
         }
     }
 
+    //returns false if not signalled until the deadline
+    bool waitUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        auto count = m_count.fetch_sub(1, std::memory_order_relaxed);
+        if (count >= 1)
+        {
+            return true;
+        }
+
+        instrumentation::onWaitBegin(this);
+        if (m_semaphore.waitUntil(deadline))
+        {
+            instrumentation::onWaitEnd(this);
+            return true;
+        }
+
+        //timed out, but a signal may have been sent to us in the meantime
+        //either we are still counted as a waiter (count < 0) and remove ourselves,
+        //or the signaller has already posted the semaphore for us and we consume the post
+        count = m_count.load(std::memory_order_relaxed);
+        while (count < 0)
+        {
+            if (m_count.compare_exchange_weak(count, count + 1, std::memory_order_relaxed, std::memory_order_relaxed))
+            {
+                instrumentation::onWaitEnd(this);
+                return false;
+            }
+        }
+        m_semaphore.wait(); //returns immediately (or very soon)
+        instrumentation::onWaitEnd(this);
+        return true;
+    }
+
+    bool waitFor(std::chrono::nanoseconds timeout)
+    {
+        return waitUntil(std::chrono::steady_clock::now() + timeout);
+    }
+
 private:
+    template <typename T>
+    friend struct WaitAnySource; //see wait_any.hpp
+
     //m_count is always <= 1, with 1 indicating it was signalled
     //                             0 not signaled, no waiting threads
     //                             -n, n<0, n threads waiting for a signal
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "report.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+//prints the difference of b relative to a for every configuration both were measured with
+//(throughput, latency percentiles and all extra values, e.g. counters per operation)
+inline void printComparison(const std::vector<Result> &results, const std::string &a, const std::string &b,
+                            std::ostream &out = std::cout)
+{
+    auto relative = [](double base, double value) {
+        return base != 0.0 ? 100.0 * (value - base) / base : 0.0;
+    };
+
+    auto line = [&](const std::string &name, double base, double value) {
+        out << "  " << std::left << std::setw(24) << name << std::right << std::fixed
+            << std::setprecision(2) << std::setw(14) << base << std::setw(14) << value
+            << std::setprecision(1) << std::showpos << std::setw(10) << relative(base, value) << "%"
+            << std::noshowpos << "\n";
+    };
+
+    out << "\ncomparison " << b << " relative to " << a << "\n";
+
+    for (auto &resultA : results)
+    {
+        if (resultA.primitive != a)
+        {
+            continue;
+        }
+        for (auto &resultB : results)
+        {
+            if (resultB.primitive != b || resultB.workload != resultA.workload ||
+                resultB.threads != resultA.threads || resultB.criticalSection != resultA.criticalSection)
+            {
+                continue;
+            }
+
+            out << resultA.workload << " threads " << resultA.threads << " cs " << resultA.criticalSection << "\n";
+            line("ops/s", resultA.opsMedian, resultB.opsMedian);
+            line("p50 ns", resultA.latency.percentile(50.0), resultB.latency.percentile(50.0));
+            line("p99 ns", resultA.latency.percentile(99.0), resultB.latency.percentile(99.0));
+            line("p99.9 ns", resultA.latency.percentile(99.9), resultB.latency.percentile(99.9));
+            line("max ns", resultA.latency.max(), resultB.latency.max());
+
+            for (auto &valueA : resultA.extra)
+            {
+                for (auto &valueB : resultB.extra)
+                {
+                    if (valueA.first == valueB.first)
+                    {
+                        line(valueA.first, valueA.second, valueB.second);
+                    }
+                }
+            }
+        }
+    }
+    out << std::flush;
+}
+
+} // namespace bench
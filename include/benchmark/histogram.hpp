@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace bench
+{
+
+//HDR-style log-linear histogram for latencies (or any other non-negative values)
+//values below 2^SubBucketBits are recorded exactly, above that every power of two range is split into
+//2^SubBucketBits linear sub buckets, i.e. the relative error is bounded by 2^-SubBucketBits
+//recording is a few instructions and never allocates, so it can be used in the measured loop
+template <uint32_t SubBucketBits = 5>
+class Histogram
+{
+    static_assert(SubBucketBits > 0 && SubBucketBits < 16, "unreasonable sub bucket precision");
+
+    static constexpr uint64_t SUB_BUCKETS = uint64_t(1) << SubBucketBits;
+    static constexpr uint64_t NUM_BUCKETS = (65 - SubBucketBits) * SUB_BUCKETS;
+
+public:
+    void record(uint64_t value)
+    {
+        ++m_buckets[bucketIndex(value)];
+        ++m_count;
+        m_sum += value;
+        if (value < m_min)
+        {
+            m_min = value;
+        }
+        if (value > m_max)
+        {
+            m_max = value;
+        }
+    }
+
+    void merge(const Histogram &other)
+    {
+        for (uint64_t i = 0; i < NUM_BUCKETS; ++i)
+        {
+            m_buckets[i] += other.m_buckets[i];
+        }
+        m_count += other.m_count;
+        m_sum += other.m_sum;
+        m_min = other.m_min < m_min ? other.m_min : m_min;
+        m_max = other.m_max > m_max ? other.m_max : m_max;
+    }
+
+    void reset()
+    {
+        *this = Histogram();
+    }
+
+    uint64_t count() const
+    {
+        return m_count;
+    }
+
+    uint64_t min() const
+    {
+        return m_count > 0 ? m_min : 0;
+    }
+
+    uint64_t max() const
+    {
+        return m_max;
+    }
+
+    double mean() const
+    {
+        return m_count > 0 ? double(m_sum) / double(m_count) : 0.0;
+    }
+
+    //p in [0, 100], returns the highest value equivalent to the bucket containing the percentile
+    //(clamped to the exact maximum, so percentile(100) == max())
+    uint64_t percentile(double p) const
+    {
+        if (m_count == 0)
+        {
+            return 0;
+        }
+
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * double(m_count) + 0.5);
+        rank = rank < 1 ? 1 : (rank > m_count ? m_count : rank);
+
+        uint64_t seen = 0;
+        for (uint64_t i = 0; i < NUM_BUCKETS; ++i)
+        {
+            seen += m_buckets[i];
+            if (seen >= rank)
+            {
+                auto value = highestEquivalentValue(i);
+                return value < m_max ? value : m_max;
+            }
+        }
+        return m_max;
+    }
+
+    //iterate the non-empty buckets (e.g. to export the full distribution), f(lowestValue, highestValue, count)
+    template <typename F>
+    void forEachBucket(F f) const
+    {
+        for (uint64_t i = 0; i < NUM_BUCKETS; ++i)
+        {
+            if (m_buckets[i] > 0)
+            {
+                f(lowestEquivalentValue(i), highestEquivalentValue(i), m_buckets[i]);
+            }
+        }
+    }
+
+private:
+    std::array<uint64_t, NUM_BUCKETS> m_buckets{};
+    uint64_t m_count{0};
+    uint64_t m_sum{0};
+    uint64_t m_min{std::numeric_limits<uint64_t>::max()};
+    uint64_t m_max{0};
+
+    static uint64_t bucketIndex(uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+        {
+            return value;
+        }
+        uint64_t magnitude = 63 - __builtin_clzll(value);
+        uint64_t shift = magnitude - SubBucketBits;
+        return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+    }
+
+    static uint64_t lowestEquivalentValue(uint64_t index)
+    {
+        if (index < SUB_BUCKETS)
+        {
+            return index;
+        }
+        uint64_t shift = index / SUB_BUCKETS - 1;
+        return (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    }
+
+    static uint64_t highestEquivalentValue(uint64_t index)
+    {
+        if (index < SUB_BUCKETS)
+        {
+            return index;
+        }
+        uint64_t shift = index / SUB_BUCKETS - 1;
+        return lowestEquivalentValue(index) + ((uint64_t(1) << shift) - 1);
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+enum class Format
+{
+    TEXT,
+    CSV,
+    JSON
+};
+
+//command line configuration shared by all benchmark drivers
+//every parameter that accepts a list (e.g. --threads=1,2,4) spans one run per value
+struct Options
+{
+    std::vector<uint32_t> threads{1, 2, 4};
+    std::vector<uint32_t> criticalSection{0, 100};
+    uint64_t iterations{100000};
+    uint32_t repeats{3};
+    uint32_t warmup{1};
+    Format format{Format::TEXT};
+    std::string filter; //only run primitives whose name contains this string (all if empty)
+    bool perf{false};   //collect hardware/software counters via perf_event_open
+    std::vector<std::string> compare; //run exactly these two primitives and print their difference
+
+    virtual ~Options() = default;
+
+    bool selected(const std::string &name) const
+    {
+        if (!compare.empty() && name != compare[0] && name != compare[1])
+        {
+            return false;
+        }
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    static void usage(const char *program)
+    {
+        std::cerr << "usage: " << program << " [options]\n"
+                  << "  --threads=N[,N...]     number of threads (per role for producer/consumer workloads)\n"
+                  << "  --cs=N[,N...]          critical section length in busy loop iterations\n"
+                  << "  --iterations=N         operations per thread and run\n"
+                  << "  --repeats=N            measured runs per configuration\n"
+                  << "  --warmup=N             discarded runs per configuration\n"
+                  << "  --format=text|csv|json output format\n"
+                  << "  --filter=NAME          only run primitives whose name contains NAME\n"
+                  << "  --perf                 report perf_event_open counters per operation\n"
+                  << "  --compare=A,B          run primitives A and B only and print the relative difference\n";
+    }
+
+    //returns false if the arguments could not be parsed (usage was printed)
+    bool parse(int argc, char **argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg(argv[i]);
+            if (arg == "--help" || arg == "-h")
+            {
+                usage(argv[0]);
+                return false;
+            }
+
+            auto pos = arg.find('=');
+            std::string key = arg.substr(0, pos);
+            std::string value = pos == std::string::npos ? std::string() : arg.substr(pos + 1);
+
+            if (!parseArgument(key, value))
+            {
+                std::cerr << "invalid argument " << arg << "\n";
+                usage(argv[0]);
+                return false;
+            }
+        }
+        return true;
+    }
+
+protected:
+    //derived option sets can extend the argument parsing
+    virtual bool parseExtension(const std::string &key, const std::string &value)
+    {
+        (void)key;
+        (void)value;
+        return false;
+    }
+
+    static bool parseList(const std::string &value, std::vector<uint32_t> &list)
+    {
+        list.clear();
+        size_t start = 0;
+        while (start < value.size())
+        {
+            auto end = value.find(',', start);
+            end = end == std::string::npos ? value.size() : end;
+            char *last = nullptr;
+            auto number = std::strtoul(value.c_str() + start, &last, 10);
+            if (last != value.c_str() + end)
+            {
+                return false;
+            }
+            list.push_back(static_cast<uint32_t>(number));
+            start = end + 1;
+        }
+        return !list.empty();
+    }
+
+    static bool parseNumber(const std::string &value, uint64_t &number)
+    {
+        char *last = nullptr;
+        number = std::strtoull(value.c_str(), &last, 10);
+        return !value.empty() && *last == '\0';
+    }
+
+private:
+    bool parseArgument(const std::string &key, const std::string &value)
+    {
+        uint64_t number;
+        if (key == "--threads")
+        {
+            return parseList(value, threads);
+        }
+        if (key == "--cs")
+        {
+            return parseList(value, criticalSection);
+        }
+        if (key == "--iterations")
+        {
+            return parseNumber(value, iterations) && iterations > 0;
+        }
+        if (key == "--repeats")
+        {
+            bool ok = parseNumber(value, number) && number > 0;
+            repeats = static_cast<uint32_t>(number);
+            return ok;
+        }
+        if (key == "--warmup")
+        {
+            bool ok = parseNumber(value, number);
+            warmup = static_cast<uint32_t>(number);
+            return ok;
+        }
+        if (key == "--format")
+        {
+            if (value == "text")
+            {
+                format = Format::TEXT;
+            }
+            else if (value == "csv")
+            {
+                format = Format::CSV;
+            }
+            else if (value == "json")
+            {
+                format = Format::JSON;
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        }
+        if (key == "--filter")
+        {
+            filter = value;
+            return true;
+        }
+        if (key == "--perf")
+        {
+            perf = true;
+            return value.empty();
+        }
+        if (key == "--compare")
+        {
+            auto comma = value.find(',');
+            if (comma == std::string::npos || comma == 0 || comma + 1 == value.size())
+            {
+                return false;
+            }
+            compare = {value.substr(0, comma), value.substr(comma + 1)};
+            return true;
+        }
+        return parseExtension(key, value);
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,223 @@
+#pragma once
+
+#include "futex.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+//hardware and software counters of this process (all threads created after open()) via perf_event_open
+//counters that cannot be opened (missing hardware support, perf_event_paranoid, no tracefs access) are skipped
+//
+//futex syscalls are counted with the syscalls:sys_enter_futex tracepoint, if it is not available and the
+//primitives are compiled with CP_COUNT_FUTEX_CALLS, the user-space counter of futex.hpp is used instead
+//(it only counts the futex calls of our primitives, not those of e.g. std::mutex)
+class PerfCounters
+{
+public:
+    using Values = std::vector<std::pair<std::string, uint64_t>>;
+
+    static PerfCounters &instance()
+    {
+        static PerfCounters counters;
+        return counters;
+    }
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters(PerfCounters &&) = delete;
+
+    ~PerfCounters()
+    {
+        for (auto &counter : m_counters)
+        {
+            close(counter.fd);
+        }
+    }
+
+    //must be called before the measured threads are created (counters are inherited on thread creation)
+    //returns false if no counter at all is available
+    bool open()
+    {
+        if (m_open)
+        {
+            return true;
+        }
+
+        add("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        add("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        add("cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        add("context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+
+        auto futexTracepoint = tracepointId("syscalls/sys_enter_futex");
+        if (futexTracepoint > 0)
+        {
+            m_hasFutexTracepoint = add("futex", PERF_TYPE_TRACEPOINT, futexTracepoint);
+        }
+
+        m_open = true;
+        return !m_counters.empty() || hasFutexFallback();
+    }
+
+    bool isOpen() const
+    {
+        return m_open;
+    }
+
+    //names of the counters that could not be opened
+    const std::vector<std::string> &unavailable() const
+    {
+        return m_unavailable;
+    }
+
+    void start()
+    {
+        if (!m_open)
+        {
+            return;
+        }
+        for (auto &counter : m_counters)
+        {
+            ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#ifdef CP_COUNT_FUTEX_CALLS
+        m_futexCallsAtStart = futexCalls();
+#endif
+    }
+
+    void stop()
+    {
+        if (!m_open)
+        {
+            return;
+        }
+        for (auto &counter : m_counters)
+        {
+            ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+#ifdef CP_COUNT_FUTEX_CALLS
+        m_futexCallsAtStop = futexCalls();
+#endif
+    }
+
+    //counter values between the last start() and stop()
+    Values read() const
+    {
+        Values values;
+        if (!m_open)
+        {
+            return values;
+        }
+
+        for (auto &counter : m_counters)
+        {
+            uint64_t value = 0;
+            if (::read(counter.fd, &value, sizeof(value)) == sizeof(value))
+            {
+                values.emplace_back(counter.name, value);
+            }
+        }
+
+        if (hasFutexFallback())
+        {
+#ifdef CP_COUNT_FUTEX_CALLS
+            values.emplace_back("futex(user)", m_futexCallsAtStop - m_futexCallsAtStart);
+#endif
+        }
+        return values;
+    }
+
+private:
+    struct Counter
+    {
+        std::string name;
+        int fd;
+    };
+
+    std::vector<Counter> m_counters;
+    std::vector<std::string> m_unavailable;
+    bool m_open{false};
+    bool m_hasFutexTracepoint{false};
+    uint64_t m_futexCallsAtStart{0};
+    uint64_t m_futexCallsAtStop{0};
+
+    PerfCounters() = default;
+
+    bool hasFutexFallback() const
+    {
+#ifdef CP_COUNT_FUTEX_CALLS
+        return !m_hasFutexTracepoint;
+#else
+        return false;
+#endif
+    }
+
+#ifdef CP_COUNT_FUTEX_CALLS
+    static uint64_t futexCalls()
+    {
+        auto &counters = futex::callCounters();
+        return counters.waits.load(std::memory_order_relaxed) + counters.wakes.load(std::memory_order_relaxed);
+    }
+#endif
+
+    bool add(const char *name, uint32_t type, uint64_t config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_hv = 1;
+
+        //kernel time matters (futex syscalls), but counting it may not be permitted
+        int fd = perfEventOpen(attr);
+        if (fd < 0 && type != PERF_TYPE_TRACEPOINT)
+        {
+            attr.exclude_kernel = 1;
+            fd = perfEventOpen(attr);
+        }
+
+        if (fd < 0)
+        {
+            m_unavailable.emplace_back(name);
+            return false;
+        }
+        m_counters.push_back({name, fd});
+        return true;
+    }
+
+    static int perfEventOpen(perf_event_attr &attr)
+    {
+        //this process (and inherited threads), any cpu, no group, no flags
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    static uint64_t tracepointId(const std::string &event)
+    {
+        for (auto root : {"/sys/kernel/tracing/events/", "/sys/kernel/debug/tracing/events/"})
+        {
+            std::ifstream file(root + event + "/id");
+            uint64_t id;
+            if (file >> id)
+            {
+                return id;
+            }
+        }
+        return 0;
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "histogram.hpp"
+#include "options.hpp"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+//one row of output, i.e. one configuration of one primitive aggregated over all measured repeats
+struct Result
+{
+    std::string primitive;
+    std::string workload;
+    uint32_t threads{0};
+    uint32_t criticalSection{0};
+    uint64_t iterations{0};
+    uint32_t repeats{0};
+
+    //operations per second of all threads, over the repeats
+    double opsMedian{0};
+    double opsMin{0};
+    double opsMax{0};
+
+    //latency of a single operation in nanoseconds, merged over all threads and repeats
+    Histogram<> latency;
+
+    //correctness, e.g. mutual exclusion violations, must be 0
+    uint64_t errors{0};
+
+    //additional named values (e.g. hardware counters), printed as extra columns
+    std::vector<std::pair<std::string, double>> extra;
+};
+
+class Report
+{
+public:
+    Report(Format format, std::ostream &out = std::cout) : m_format(format), m_out(out)
+    {
+    }
+
+    Report(const Report &) = delete;
+    Report(Report &&) = delete;
+
+    ~Report()
+    {
+        if (m_format == Format::JSON)
+        {
+            m_out << (m_rows == 0 ? "[" : "\n") << "]" << std::endl;
+        }
+    }
+
+    void add(const Result &result)
+    {
+        switch (m_format)
+        {
+        case Format::TEXT:
+            writeText(result);
+            break;
+        case Format::CSV:
+            writeCsv(result);
+            break;
+        case Format::JSON:
+            writeJson(result);
+            break;
+        }
+        ++m_rows;
+        m_results.push_back(result);
+    }
+
+    //all results added so far (e.g. for comparisons)
+    const std::vector<Result> &results() const
+    {
+        return m_results;
+    }
+
+private:
+    Format m_format;
+    std::ostream &m_out;
+    uint64_t m_rows{0};
+    std::vector<Result> m_results;
+
+    static constexpr const char *PERCENTILE_NAMES[] = {"p50", "p99", "p99.9", "max"};
+
+    static std::vector<uint64_t> percentiles(const Result &result)
+    {
+        return {result.latency.percentile(50.0), result.latency.percentile(99.0),
+                result.latency.percentile(99.9), result.latency.max()};
+    }
+
+    void writeText(const Result &result)
+    {
+        auto p = percentiles(result);
+        m_out << std::left << std::setw(24) << result.primitive << std::setw(10) << result.workload
+              << std::right << " threads " << std::setw(3) << result.threads
+              << " cs " << std::setw(5) << result.criticalSection
+              << std::fixed << std::setprecision(0)
+              << " | ops/s " << std::setw(11) << result.opsMedian
+              << " [" << result.opsMin << ", " << result.opsMax << "]"
+              << " | ns";
+        for (size_t i = 0; i < p.size(); ++i)
+        {
+            m_out << " " << PERCENTILE_NAMES[i] << " " << p[i];
+        }
+        m_out << " | errors " << result.errors;
+        for (auto &value : result.extra)
+        {
+            m_out << " " << value.first << " " << std::setprecision(2) << value.second;
+        }
+        m_out << std::endl;
+    }
+
+    void writeCsv(const Result &result)
+    {
+        if (m_rows == 0)
+        {
+            m_out << "primitive,workload,threads,cs,iterations,repeats,ops_median,ops_min,ops_max,"
+                  << "mean_ns,p50_ns,p99_ns,p999_ns,max_ns,errors";
+            for (auto &value : result.extra)
+            {
+                m_out << "," << value.first;
+            }
+            m_out << "\n";
+        }
+
+        auto p = percentiles(result);
+        m_out << result.primitive << "," << result.workload << "," << result.threads << ","
+              << result.criticalSection << "," << result.iterations << "," << result.repeats << ","
+              << std::fixed << std::setprecision(1)
+              << result.opsMedian << "," << result.opsMin << "," << result.opsMax << ","
+              << result.latency.mean();
+        for (auto value : p)
+        {
+            m_out << "," << value;
+        }
+        m_out << "," << result.errors;
+        for (auto &value : result.extra)
+        {
+            m_out << "," << std::setprecision(3) << value.second;
+        }
+        m_out << std::endl;
+    }
+
+    void writeJson(const Result &result)
+    {
+        auto p = percentiles(result);
+        m_out << (m_rows == 0 ? "[\n" : ",\n")
+              << "  {\"primitive\": \"" << result.primitive << "\", \"workload\": \"" << result.workload
+              << "\", \"threads\": " << result.threads << ", \"cs\": " << result.criticalSection
+              << ", \"iterations\": " << result.iterations << ", \"repeats\": " << result.repeats
+              << std::fixed << std::setprecision(1)
+              << ", \"ops_median\": " << result.opsMedian << ", \"ops_min\": " << result.opsMin
+              << ", \"ops_max\": " << result.opsMax
+              << ", \"latency_ns\": {\"mean\": " << result.latency.mean()
+              << ", \"p50\": " << p[0] << ", \"p99\": " << p[1] << ", \"p99.9\": " << p[2] << ", \"max\": " << p[3]
+              << "}, \"errors\": " << result.errors;
+        for (auto &value : result.extra)
+        {
+            m_out << ", \"" << value.first << "\": " << std::setprecision(3) << value.second;
+        }
+        m_out << "}";
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+//relative placement of two communicating threads
+enum class Placement
+{
+    UNPINNED,    //left to the scheduler
+    SIBLING,     //two hardware threads of the same core (SMT)
+    SAME_SOCKET, //different cores of the same socket (shared last level cache)
+    CROSS_SOCKET //different sockets
+};
+
+inline const char *toString(Placement placement)
+{
+    switch (placement)
+    {
+    case Placement::UNPINNED:
+        return "unpinned";
+    case Placement::SIBLING:
+        return "sibling";
+    case Placement::SAME_SOCKET:
+        return "socket";
+    case Placement::CROSS_SOCKET:
+        return "cross";
+    }
+    return "unknown";
+}
+
+//cpu topology as reported by sysfs (linux only), restricted to the cpus this process may run on
+class Topology
+{
+public:
+    struct Cpu
+    {
+        int id;
+        int core;
+        int socket;
+    };
+
+    Topology()
+    {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        {
+            return;
+        }
+
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (!CPU_ISSET(cpu, &allowed))
+            {
+                continue;
+            }
+            auto core = readInt(cpu, "core_id");
+            auto socket = readInt(cpu, "physical_package_id");
+            if (core.has_value() && socket.has_value())
+            {
+                m_cpus.push_back({cpu, *core, *socket});
+            }
+        }
+    }
+
+    const std::vector<Cpu> &cpus() const
+    {
+        return m_cpus;
+    }
+
+    //a pair of cpus with the requested placement, if the machine has one
+    std::optional<std::pair<int, int>> findPair(Placement placement) const
+    {
+        for (auto &a : m_cpus)
+        {
+            for (auto &b : m_cpus)
+            {
+                if (a.id >= b.id)
+                {
+                    continue;
+                }
+                bool sameSocket = a.socket == b.socket;
+                bool sameCore = sameSocket && a.core == b.core;
+
+                if ((placement == Placement::SIBLING && sameCore) ||
+                    (placement == Placement::SAME_SOCKET && sameSocket && !sameCore) ||
+                    (placement == Placement::CROSS_SOCKET && !sameSocket))
+                {
+                    return std::make_pair(a.id, b.id);
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    //pin the calling thread to a single cpu
+    static bool pin(int cpu)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+private:
+    std::vector<Cpu> m_cpus;
+
+    static std::optional<int> readInt(int cpu, const char *name)
+    {
+        std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+        int value;
+        if (file >> value)
+        {
+            return value;
+        }
+        return std::nullopt;
+    }
+};
+
+} // namespace bench
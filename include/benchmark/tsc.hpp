@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench
+{
+
+//time stamp counter, i.e. a cycle accurate timestamp that is cheap enough to be taken on both sides of a wake up
+//requires an invariant TSC that is synchronized across cores (true for all recent x86 CPUs),
+//other architectures fall back to the steady clock (in ns, i.e. 1 tick per ns)
+class Tsc
+{
+public:
+    static uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        //lfence prevents the read from being executed before preceding instructions
+        //(e.g. the load that told us we were woken up)
+        _mm_lfence();
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+#endif
+    }
+
+    //measures the TSC frequency against the steady clock (once, takes calibrationTime)
+    static double ticksPerNs(std::chrono::milliseconds calibrationTime = std::chrono::milliseconds(100))
+    {
+        static double ticks = calibrate(calibrationTime);
+        return ticks;
+    }
+
+    static uint64_t toNs(uint64_t ticks)
+    {
+        return static_cast<uint64_t>(double(ticks) / ticksPerNs());
+    }
+
+private:
+    static double calibrate(std::chrono::milliseconds calibrationTime)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        auto startTime = std::chrono::steady_clock::now();
+        auto startTicks = now();
+        std::this_thread::sleep_for(calibrationTime);
+        auto endTime = std::chrono::steady_clock::now();
+        auto endTicks = now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+        return ns > 0 ? double(endTicks - startTicks) / double(ns) : 1.0;
+#else
+        (void)calibrationTime;
+        return 1.0;
+#endif
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "histogram.hpp"
+#include "options.hpp"
+#include "perf_counters.hpp"
+#include "report.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench
+{
+
+inline uint64_t now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+//simulated work of configurable length (e.g. inside a critical section), cannot be optimized away
+inline void busyWork(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        asm volatile("" ::: "memory");
+    }
+}
+
+//lets all threads of a run start at (roughly) the same time, the coordinator measures from release()
+class StartBarrier
+{
+public:
+    void arriveAndWait()
+    {
+        m_arrived.fetch_add(1, std::memory_order_acq_rel);
+        while (!m_go.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    void release(uint32_t expected)
+    {
+        while (m_arrived.load(std::memory_order_acquire) < expected)
+        {
+            std::this_thread::yield();
+        }
+        m_go.store(true, std::memory_order_release);
+    }
+
+private:
+    std::atomic<uint32_t> m_arrived{0};
+    std::atomic<bool> m_go{false};
+};
+
+//outcome of a single (measured or warmup) run
+struct Run
+{
+    uint64_t durationNs{0};
+    uint64_t operations{0};
+    uint64_t errors{0};
+    Histogram<> latency;
+    PerfCounters::Values counters; //empty if counters are not enabled
+};
+
+//by default locks are used via lock()/unlock(), specialize for locks that need more (e.g. a thread id)
+template <typename LockType>
+struct LockAdapter
+{
+    static void lock(LockType &lock, uint32_t)
+    {
+        lock.lock();
+    }
+
+    static void unlock(LockType &lock, uint32_t)
+    {
+        lock.unlock();
+    }
+};
+
+//threads repeatedly acquire the same lock, latency is the time until lock() returns
+//mutual exclusion is checked inside the critical section and violations are counted as errors
+template <typename LockType>
+Run runLock(uint32_t threads, uint64_t iterations, uint32_t criticalSection)
+{
+    LockType lock;
+    StartBarrier barrier;
+    std::atomic<int> users{0};
+    std::atomic<uint64_t> errors{0};
+    std::vector<Histogram<>> histograms(threads);
+
+    auto work = [&](uint32_t index) {
+        auto &histogram = histograms[index];
+        uint32_t id = index + 1;
+        barrier.arriveAndWait();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            auto start = now();
+            LockAdapter<LockType>::lock(lock, id);
+            histogram.record(now() - start);
+
+            if (users.fetch_add(1, std::memory_order_acq_rel) != 0)
+            {
+                errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            busyWork(criticalSection);
+            users.fetch_sub(1, std::memory_order_release);
+
+            LockAdapter<LockType>::unlock(lock, id);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (uint32_t i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(work, i);
+    }
+
+    auto &counters = PerfCounters::instance();
+    counters.start();
+    barrier.release(threads);
+    auto start = now();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    counters.stop();
+
+    Run run;
+    run.durationNs = now() - start;
+    run.counters = counters.read();
+    run.operations = threads * iterations;
+    run.errors = errors.load();
+    for (auto &histogram : histograms)
+    {
+        run.latency.merge(histogram);
+    }
+    return run;
+}
+
+//threads consumers wait on the semaphore and threads producers post it (with criticalSection work between posts)
+//latency is the time until wait() returns, any count remaining at the end is an error
+template <typename SemaphoreType>
+Run runSemaphore(uint32_t threads, uint64_t iterations, uint32_t criticalSection)
+{
+    SemaphoreType semaphore;
+    StartBarrier barrier;
+    std::vector<Histogram<>> histograms(threads);
+
+    auto consume = [&](uint32_t index) {
+        auto &histogram = histograms[index];
+        barrier.arriveAndWait();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            auto start = now();
+            semaphore.wait();
+            histogram.record(now() - start);
+        }
+    };
+
+    auto produce = [&]() {
+        barrier.arriveAndWait();
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            semaphore.post();
+            busyWork(criticalSection);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(2 * threads);
+    for (uint32_t i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(consume, i);
+        workers.emplace_back(produce);
+    }
+
+    auto &counters = PerfCounters::instance();
+    counters.start();
+    barrier.release(2 * threads);
+    auto start = now();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    counters.stop();
+
+    Run run;
+    run.durationNs = now() - start;
+    run.counters = counters.read();
+    run.operations = threads * iterations;
+    while (semaphore.tryWait())
+    {
+        ++run.errors;
+    }
+    for (auto &histogram : histograms)
+    {
+        run.latency.merge(histogram);
+    }
+    return run;
+}
+
+//executes the warmup and measured runs of one configuration and aggregates them
+inline Result measure(const std::string &primitive, const std::string &workload, const Options &options,
+                      uint32_t threads, uint32_t criticalSection, const std::function<Run()> &run)
+{
+    Result result;
+    result.primitive = primitive;
+    result.workload = workload;
+    result.threads = threads;
+    result.criticalSection = criticalSection;
+    result.iterations = options.iterations;
+    result.repeats = options.repeats;
+
+    for (uint32_t i = 0; i < options.warmup; ++i)
+    {
+        run();
+    }
+
+    std::vector<double> throughput;
+    std::vector<std::string> counterNames; //keeps the order of the counters
+    std::map<std::string, uint64_t> counterSums;
+    uint64_t operations = 0;
+    for (uint32_t i = 0; i < options.repeats; ++i)
+    {
+        auto measured = run();
+        throughput.push_back(measured.durationNs > 0 ? 1e9 * double(measured.operations) / double(measured.durationNs) : 0.0);
+        result.latency.merge(measured.latency);
+        result.errors += measured.errors;
+        operations += measured.operations;
+        for (auto &counter : measured.counters)
+        {
+            if (counterSums.find(counter.first) == counterSums.end())
+            {
+                counterNames.push_back(counter.first);
+            }
+            counterSums[counter.first] += counter.second;
+        }
+    }
+
+    for (auto &name : counterNames)
+    {
+        result.extra.emplace_back(name + "/op", operations > 0 ? double(counterSums[name]) / double(operations) : 0.0);
+    }
+
+    std::sort(throughput.begin(), throughput.end());
+    result.opsMin = throughput.front();
+    result.opsMax = throughput.back();
+    result.opsMedian = throughput[throughput.size() / 2];
+    return result;
+}
+
+//runs all configurations (threads x critical section lengths) of a primitive
+template <typename RunFunction>
+void runAll(Report &report, const std::string &primitive, const std::string &workload, const Options &options, RunFunction runFunction)
+{
+    if (!options.selected(primitive))
+    {
+        return;
+    }
+
+    for (auto threads : options.threads)
+    {
+        if (threads == 0)
+        {
+            continue;
+        }
+        for (auto criticalSection : options.criticalSection)
+        {
+            report.add(measure(primitive, workload, options, threads, criticalSection,
+                               [&]() { return runFunction(threads, options.iterations, criticalSection); }));
+        }
+    }
+}
+
+} // namespace bench
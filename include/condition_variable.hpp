@@ -2,9 +2,9 @@
 
 #include "semaphore.hpp"
 #include "lock.hpp"
+#include "instrumentation/probes.hpp"
 
-#include <mutex>      //only for lock_guard which can easily be implemented on its own
-#include <functional> //for the predicate, can be dropped if we pass the callable via template as e.g. std::thread does
+#include <mutex> //only for lock_guard which can easily be implemented on its own
 
 //major todo: implement this variant without list nodes but just one semaphore, limited use case for only one predicate
 
@@ -30,6 +30,7 @@ public:
 
     void wait()
     {
+        instrumentation::onWaitBegin(this);
         auto node = new WaitNode;
 
         {
@@ -45,6 +46,7 @@ public:
 
         node->semaphore.wait();
         delete node;
+        instrumentation::onWaitEnd(this);
     }
 
     //Precondition: lock must be locked before the call (this can be dropped as far as I can see)
@@ -64,6 +66,7 @@ public:
 
         //note that these could come from a pool instead of new, limiting the number of possible waiting threads
         //in a directly controllable way (technically we are also limited now by the OS and available memory)
+        instrumentation::onWaitBegin(this);
         auto node = new WaitNode;
 
         {
@@ -79,11 +82,13 @@ public:
 
         //note that if the lock is not available we will proceed once it is, we were still woken up
         lock.lock();
+        instrumentation::onWaitEnd(this);
     }
 
     //TODO: perfect forwarding with arbitrary predicate arguments (syntactic sugar)
-    template <typename LockType>
-    void wait(LockType &lock, std::function<bool(void)> predicate)
+    //the predicate is a template parameter (as e.g. for std::thread), i.e. it can be inlined and is not copied
+    template <typename LockType, typename Predicate>
+    void wait(LockType &lock, Predicate predicate)
     {
         if (predicate())
         {
@@ -92,6 +97,7 @@ public:
 
         //todo: notify here may be a problem, "lost wakeup"
 
+        instrumentation::onWaitBegin(this);
         auto node = new WaitNode;
 
         {
@@ -138,11 +144,13 @@ public:
         } while (true);
 
         delete node;
+        instrumentation::onWaitEnd(this);
     }
 
     void
     notifyOne()
     {
+        instrumentation::onSignal(this);
         std::lock_guard<Lock> guard(waitListLock);
         if (waitList)
         {
@@ -153,6 +161,7 @@ public:
 
     void notifyAll()
     {
+        instrumentation::onSignal(this);
         std::lock_guard<Lock> guard(waitListLock);
         while (waitList)
         {
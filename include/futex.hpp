@@ -0,0 +1,126 @@
+#pragma once
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+#ifndef SYS_futex_waitv
+#define SYS_futex_waitv 449 //Linux 5.16, the same number on all architectures
+#endif
+
+//thin wrappers of the futex syscalls used by the primitives
+//
+//if CP_COUNT_FUTEX_CALLS is defined, every syscall is counted (process wide)
+//this is meant for benchmarks where the futex tracepoint cannot be used (e.g. restricted perf access)
+namespace futex
+{
+
+#ifdef CP_COUNT_FUTEX_CALLS
+struct CallCounters
+{
+    std::atomic<uint64_t> waits{0};
+    std::atomic<uint64_t> wakes{0};
+};
+
+inline CallCounters &callCounters()
+{
+    static CallCounters counters;
+    return counters;
+}
+#endif
+
+//the steady clock is CLOCK_MONOTONIC on Linux
+inline timespec toTimespec(std::chrono::steady_clock::time_point deadline)
+{
+    auto sinceEpoch = deadline.time_since_epoch();
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+    timespec time;
+    time.tv_sec = seconds.count();
+    time.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch - seconds).count();
+    return time;
+}
+
+//sleeps if *futexWord == expected (checked atomically by the kernel), may return spuriously
+inline void wait(int32_t *futexWord, int32_t expected)
+{
+#ifdef CP_COUNT_FUTEX_CALLS
+    callCounters().waits.fetch_add(1, std::memory_order_relaxed);
+#endif
+    //the last 3 arguments are unused by the FUTEX_WAIT call
+    syscall(SYS_futex, futexWord, FUTEX_WAIT, expected, nullptr, nullptr, 0);
+}
+
+//as wait but returns false if the (absolute) deadline has passed, the steady clock is CLOCK_MONOTONIC on Linux
+inline bool waitUntil(int32_t *futexWord, int32_t expected, std::chrono::steady_clock::time_point deadline)
+{
+#ifdef CP_COUNT_FUTEX_CALLS
+    callCounters().waits.fetch_add(1, std::memory_order_relaxed);
+#endif
+    auto time = toTimespec(deadline);
+
+    //unlike FUTEX_WAIT (relative timeout), FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC time,
+    //i.e. a retry after a spurious wake up does not extend the timeout
+    auto result = syscall(SYS_futex, futexWord, FUTEX_WAIT_BITSET, expected, &time, nullptr, FUTEX_BITSET_MATCH_ANY);
+    return result == 0 || errno != ETIMEDOUT;
+}
+
+//one futex word of waitv, the layout of struct futex_waitv (which older kernel headers do not have)
+struct WaitvEntry
+{
+    uint64_t value;   //expected value
+    uint64_t address; //of the futex word
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+constexpr uint32_t WAITV_SIZE_U32 = 0x02; //FUTEX_32, the only supported size (shared futex, as the other calls)
+constexpr uint32_t WAITV_MAX = 128;
+
+inline WaitvEntry waitvEntry(int32_t *futexWord, int32_t expected)
+{
+    return WaitvEntry{static_cast<uint32_t>(expected), reinterpret_cast<uintptr_t>(futexWord), WAITV_SIZE_U32, 0};
+}
+
+//sleeps if all words have their expected values (checked atomically by the kernel) until one of them is woken,
+//may return spuriously, false if the (absolute) deadline has passed (time_point::max waits without timeout)
+inline bool waitv(WaitvEntry *entries, uint32_t count, std::chrono::steady_clock::time_point deadline)
+{
+#ifdef CP_COUNT_FUTEX_CALLS
+    callCounters().waits.fetch_add(1, std::memory_order_relaxed);
+#endif
+    timespec time;
+    timespec *timeout = nullptr;
+    if (deadline != std::chrono::steady_clock::time_point::max())
+    {
+        time = toTimespec(deadline);
+        timeout = &time;
+    }
+    //returns the index of the woken word (which we do not need, the caller checks all of them anyway)
+    auto result = syscall(SYS_futex_waitv, entries, count, 0, timeout, CLOCK_MONOTONIC);
+    return result >= 0 || errno != ETIMEDOUT;
+}
+
+//futex_waitv needs Linux 5.16 (probed once, an empty wait fails with EINVAL if the call exists)
+inline bool waitvSupported()
+{
+    static const bool supported = syscall(SYS_futex_waitv, nullptr, 0, 0, nullptr, CLOCK_MONOTONIC) == -1 && errno == EINVAL;
+    return supported;
+}
+
+//wakes up to numToWake threads sleeping on futexWord, returns the number of woken threads
+inline int wake(int32_t *futexWord, int32_t numToWake)
+{
+#ifdef CP_COUNT_FUTEX_CALLS
+    callCounters().wakes.fetch_add(1, std::memory_order_relaxed);
+#endif
+    //the last 3 arguments are unused by the FUTEX_WAKE call
+    return static_cast<int>(syscall(SYS_futex, futexWord, FUTEX_WAKE, numToWake, nullptr, nullptr, 0));
+}
+
+} // namespace futex
@@ -6,6 +6,7 @@
 
 #include <atomic>
 #include "semaphore.hpp"
+#include "instrumentation/probes.hpp"
 
 //can be used to build a recursive mutex if id is a unique thread id
 class IdAwareLock
@@ -39,6 +40,19 @@ private:
         return state.exchange(desired, std::memory_order_acq_rel);
     }
 
+    void sleep()
+    {
+        auto parkToken = instrumentation::onParking(this);
+        semaphore.wait();
+        instrumentation::onUnparked(this, parkToken);
+    }
+
+    void wakeOne()
+    {
+        instrumentation::onWaking(this);
+        semaphore.post();
+    }
+
 public:
     IdAwareLock(uint32_t maxSpinIterations = 1)
         : MAX_SPINNING_ACQUIRE_ITERATIONS(maxSpinIterations > 0 ? maxSpinIterations : 1)
@@ -51,6 +65,8 @@ public:
     //only positive values (>0), can foolproof this later
     void lock(id_t id = 0)
     {
+        bool slept = false;
+
         //try to acquire the lock by spinning
         for (uint32_t i = 0; i < MAX_SPINNING_ACQUIRE_ITERATIONS; ++i)
         {
@@ -58,17 +74,20 @@ public:
             if (knownState == UNLOCKED || knownState == id) // for recursive locking
             {
                 lockingId.store(id, std::memory_order_relaxed);
+                instrumentation::onAcquired(this, i == 0 ? instrumentation::AcquirePath::FAST : instrumentation::AcquirePath::SPIN);
                 return;
             }
             else if (knownState == CONTESTED)
             {
                 if (getLockingId() == id) // for recursive locking
                 {
+                    instrumentation::onAcquired(this, instrumentation::AcquirePath::FAST);
                     return;
                 }
                 //contested, do not try to spin any more and sleep instead
                 //(promotes fairness with respect to threads trying to acquire the lock)
-                semaphore.wait();
+                sleep();
+                slept = true;
                 break;
             }
         }
@@ -85,20 +104,27 @@ public:
 
             //note that we also do not sleep when someone sets it back to UNLOCKED before the exchange
             //and just set it to CONTESTED (false positive) and return, having acquired the lock
-            semaphore.wait();
+            if (slept)
+            {
+                instrumentation::onSpuriousWakeup(this);
+            }
+            sleep();
+            slept = true;
         }
 
         lockingId.store(id, std::memory_order_relaxed);
+        instrumentation::onAcquired(this, slept ? instrumentation::AcquirePath::SLOW : instrumentation::AcquirePath::SPIN);
     }
 
     void unlock()
     {
+        instrumentation::onReleased(this);
         lockingId.store(UNLOCKED); //slightly out of sync, but has to be done before exchange
 
         //change the lock state back to unlocked and wake someone if it was contested
         if (exchangeState(UNLOCKED) == CONTESTED)
         {
-            semaphore.post();
+            wakeOne();
         }
     }
 
@@ -110,12 +136,13 @@ public:
             std::terminate(); //protocol error
         }
 
+        instrumentation::onReleased(this);
         lockingId.store(UNLOCKED); //slightly out of sync, but has to be done before exchange
 
         //change the lock state back to unlocked and wake someone if it was contested
         if (exchangeState(UNLOCKED) == CONTESTED)
         {
-            semaphore.post();
+            wakeOne();
         }
     }
 
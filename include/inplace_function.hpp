@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t Capacity = 32>
+class InplaceFunction;
+
+//std::function replacement that stores the callable in an internal buffer of Capacity bytes and never allocates
+//callables that do not fit (or are over-aligned) do not compile
+//
+//the type specific operations are one static table per callable type (instead of virtual functions),
+//i.e. a call is one indirect call as with std::function
+template <typename R, typename... Args, size_t Capacity>
+class InplaceFunction<R(Args...), Capacity>
+{
+public:
+    InplaceFunction() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceFunction> &&
+                                                      std::is_invocable_r_v<R, std::decay_t<F> &, Args...>>>
+    InplaceFunction(F &&f)
+    {
+        using Callable = std::decay_t<F>;
+        static_assert(sizeof(Callable) <= Capacity, "callable too large for InplaceFunction, increase the capacity");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "callable is over-aligned for InplaceFunction");
+
+        new (&m_storage) Callable(std::forward<F>(f));
+        m_operations = &operations<Callable>;
+    }
+
+    InplaceFunction(const InplaceFunction &other) : m_operations(other.m_operations)
+    {
+        if (m_operations)
+        {
+            m_operations->copy(&m_storage, &other.m_storage);
+        }
+    }
+
+    InplaceFunction(InplaceFunction &&other) : m_operations(other.m_operations)
+    {
+        if (m_operations)
+        {
+            m_operations->move(&m_storage, &other.m_storage);
+        }
+    }
+
+    InplaceFunction &operator=(const InplaceFunction &rhs)
+    {
+        if (&rhs != this)
+        {
+            reset();
+            if (rhs.m_operations)
+            {
+                rhs.m_operations->copy(&m_storage, &rhs.m_storage);
+                m_operations = rhs.m_operations;
+            }
+        }
+        return *this;
+    }
+
+    InplaceFunction &operator=(InplaceFunction &&rhs)
+    {
+        if (&rhs != this)
+        {
+            reset();
+            if (rhs.m_operations)
+            {
+                rhs.m_operations->move(&m_storage, &rhs.m_storage);
+                m_operations = rhs.m_operations;
+            }
+        }
+        return *this;
+    }
+
+    ~InplaceFunction()
+    {
+        reset();
+    }
+
+    //precondition: not empty
+    R operator()(Args... args) const
+    {
+        return m_operations->invoke(&m_storage, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const
+    {
+        return m_operations != nullptr;
+    }
+
+    void reset()
+    {
+        if (m_operations)
+        {
+            m_operations->destroy(&m_storage);
+            m_operations = nullptr;
+        }
+    }
+
+private:
+    using Storage = std::aligned_storage_t<Capacity, alignof(std::max_align_t)>;
+
+    struct Operations
+    {
+        R (*invoke)(const void *, Args &&...);
+        void (*copy)(void *, const void *);
+        void (*move)(void *, void *);
+        void (*destroy)(void *);
+    };
+
+    //mutable: a const InplaceFunction can call a (non-const) lambda, as std::function
+    mutable Storage m_storage;
+    const Operations *m_operations{nullptr};
+
+    template <typename Callable>
+    static constexpr Operations operations{
+        [](const void *callable, Args &&... args) -> R {
+            return (*static_cast<Callable *>(const_cast<void *>(callable)))(std::forward<Args>(args)...);
+        },
+        [](void *to, const void *from) { new (to) Callable(*static_cast<const Callable *>(from)); },
+        [](void *to, void *from) { new (to) Callable(std::move(*static_cast<Callable *>(from))); },
+        [](void *callable) { static_cast<Callable *>(callable)->~Callable(); }};
+};
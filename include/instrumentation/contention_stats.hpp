@@ -0,0 +1,368 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace instrumentation
+{
+
+//counters of one primitive instance (either of one thread or aggregated over all threads)
+struct Counters
+{
+    //wait time buckets are powers of two in ns, i.e. bucket i counts waits in [2^i, 2^(i+1)) ns
+    static constexpr uint32_t WAIT_BUCKETS = 40;
+
+    uint64_t acquisitions{0};
+    uint64_t fastPath{0};
+    uint64_t spinSuccess{0};
+    uint64_t futexWaits{0};
+    uint64_t futexWakes{0};
+    uint64_t spuriousWakeups{0};
+    uint64_t waitTimeNs{0};
+    std::array<uint64_t, WAIT_BUCKETS> waitTime{};
+
+    void merge(const Counters &other)
+    {
+        acquisitions += other.acquisitions;
+        fastPath += other.fastPath;
+        spinSuccess += other.spinSuccess;
+        futexWaits += other.futexWaits;
+        futexWakes += other.futexWakes;
+        spuriousWakeups += other.spuriousWakeups;
+        waitTimeNs += other.waitTimeNs;
+        for (uint32_t i = 0; i < WAIT_BUCKETS; ++i)
+        {
+            waitTime[i] += other.waitTime[i];
+        }
+    }
+
+    static uint32_t bucket(uint64_t ns)
+    {
+        uint32_t index = ns > 0 ? 63 - __builtin_clzll(ns) : 0;
+        return index < WAIT_BUCKETS ? index : WAIT_BUCKETS - 1;
+    }
+};
+
+class StatsRegistry;
+
+//per thread counters of all instances the thread used, only the owning thread writes
+//(relaxed load + store instead of RMW), the registry may read concurrently
+class ThreadStats
+{
+public:
+    static constexpr uint32_t CAPACITY = 256; //instances per thread, further instances share one overflow slot
+
+    struct Slot
+    {
+        std::atomic<const void *> object{nullptr};
+        std::atomic<uint64_t> acquisitions{0};
+        std::atomic<uint64_t> fastPath{0};
+        std::atomic<uint64_t> spinSuccess{0};
+        std::atomic<uint64_t> futexWaits{0};
+        std::atomic<uint64_t> futexWakes{0};
+        std::atomic<uint64_t> spuriousWakeups{0};
+        std::atomic<uint64_t> waitTimeNs{0};
+        std::array<std::atomic<uint64_t>, Counters::WAIT_BUCKETS> waitTime{};
+
+        Counters read() const
+        {
+            Counters counters;
+            counters.acquisitions = acquisitions.load(std::memory_order_relaxed);
+            counters.fastPath = fastPath.load(std::memory_order_relaxed);
+            counters.spinSuccess = spinSuccess.load(std::memory_order_relaxed);
+            counters.futexWaits = futexWaits.load(std::memory_order_relaxed);
+            counters.futexWakes = futexWakes.load(std::memory_order_relaxed);
+            counters.spuriousWakeups = spuriousWakeups.load(std::memory_order_relaxed);
+            counters.waitTimeNs = waitTimeNs.load(std::memory_order_relaxed);
+            for (uint32_t i = 0; i < Counters::WAIT_BUCKETS; ++i)
+            {
+                counters.waitTime[i] = waitTime[i].load(std::memory_order_relaxed);
+            }
+            return counters;
+        }
+    };
+
+    static void increment(std::atomic<uint64_t> &counter, uint64_t value = 1)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    static ThreadStats &local();
+
+    ThreadStats();
+    ~ThreadStats();
+
+    ThreadStats(const ThreadStats &) = delete;
+    ThreadStats(ThreadStats &&) = delete;
+
+    Slot &slot(const void *object)
+    {
+        if (m_last->object.load(std::memory_order_relaxed) == object)
+        {
+            return *m_last;
+        }
+
+        auto hash = (reinterpret_cast<uintptr_t>(object) >> 4) * 0x9E3779B97F4A7C15ull;
+        for (uint32_t i = 0; i < CAPACITY; ++i)
+        {
+            auto &slot = m_slots[(hash + i) % CAPACITY];
+            auto current = slot.object.load(std::memory_order_relaxed);
+            if (current == object)
+            {
+                m_last = &slot;
+                return slot;
+            }
+            if (current == nullptr)
+            {
+                //counters are still 0, publish the slot for the registry
+                slot.object.store(object, std::memory_order_release);
+                m_last = &slot;
+                return slot;
+            }
+        }
+        return m_overflow;
+    }
+
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (auto &slot : m_slots)
+        {
+            auto object = slot.object.load(std::memory_order_acquire);
+            if (object)
+            {
+                f(object, slot.read());
+            }
+        }
+        f(nullptr, m_overflow.read());
+    }
+
+private:
+    std::array<Slot, CAPACITY> m_slots;
+    Slot m_overflow;
+    Slot *m_last{&m_overflow};
+};
+
+//knows all thread local counters and aggregates them on demand
+//counters of terminated threads are kept (merged), instances are identified by address
+//(an address reused by a new instance after destruction continues the counters of the old one)
+class StatsRegistry
+{
+public:
+    static StatsRegistry &instance()
+    {
+        static StatsRegistry registry;
+        return registry;
+    }
+
+    //optional human readable name of an instance used in dumps
+    void setName(const void *object, const std::string &name)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_names[object] = name;
+    }
+
+    //aggregated counters per instance (nullptr: instances that did not fit into the thread local tables)
+    std::map<const void *, Counters> snapshot()
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto result = m_retired;
+        for (auto threadStats : m_threads)
+        {
+            threadStats->forEach([&](const void *object, const Counters &counters) {
+                if (object || counters.acquisitions > 0 || counters.futexWakes > 0)
+                {
+                    result[object].merge(counters);
+                }
+            });
+        }
+        return result;
+    }
+
+    void dump(std::ostream &out, bool json = false)
+    {
+        auto counters = snapshot();
+        auto names = this->names();
+
+        out << (json ? "[" : "");
+        bool first = true;
+        for (auto &entry : counters)
+        {
+            auto &c = entry.second;
+            auto name = describe(entry.first, names);
+            if (json)
+            {
+                out << (first ? "\n" : ",\n") << "  {\"instance\": \"" << name << "\", \"acquisitions\": " << c.acquisitions
+                    << ", \"fast_path\": " << c.fastPath << ", \"spin_success\": " << c.spinSuccess
+                    << ", \"futex_waits\": " << c.futexWaits << ", \"futex_wakes\": " << c.futexWakes
+                    << ", \"spurious_wakeups\": " << c.spuriousWakeups << ", \"wait_time_ns\": " << c.waitTimeNs
+                    << ", \"wait_time_log2_ns\": [";
+                for (uint32_t i = 0; i < Counters::WAIT_BUCKETS; ++i)
+                {
+                    out << (i > 0 ? ", " : "") << c.waitTime[i];
+                }
+                out << "]}";
+            }
+            else
+            {
+                out << name << ": acquisitions " << c.acquisitions << " fast " << c.fastPath << " spin " << c.spinSuccess
+                    << " futex waits " << c.futexWaits << " wakes " << c.futexWakes << " spurious " << c.spuriousWakeups
+                    << " wait time " << c.waitTimeNs << "ns\n";
+                for (uint32_t i = 0; i < Counters::WAIT_BUCKETS; ++i)
+                {
+                    if (c.waitTime[i] > 0)
+                    {
+                        out << "    wait [" << (uint64_t(1) << i) << ", " << (uint64_t(1) << (i + 1)) << ") ns: " << c.waitTime[i] << "\n";
+                    }
+                }
+            }
+            first = false;
+        }
+        out << (json ? "\n]\n" : "") << std::flush;
+    }
+
+private:
+    friend class ThreadStats;
+
+    std::mutex m_mutex;
+    std::vector<ThreadStats *> m_threads;
+    std::map<const void *, Counters> m_retired;
+    std::map<const void *, std::string> m_names;
+
+    StatsRegistry() = default;
+
+    std::map<const void *, std::string> names()
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_names;
+    }
+
+    static std::string describe(const void *object, const std::map<const void *, std::string> &names)
+    {
+        if (!object)
+        {
+            return "untracked";
+        }
+        auto iter = names.find(object);
+        if (iter != names.end())
+        {
+            return iter->second;
+        }
+        std::ostringstream address;
+        address << object;
+        return address.str();
+    }
+
+    void add(ThreadStats *threadStats)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_threads.push_back(threadStats);
+    }
+
+    void retire(ThreadStats *threadStats)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        threadStats->forEach([&](const void *object, const Counters &counters) {
+            if (object || counters.acquisitions > 0 || counters.futexWakes > 0)
+            {
+                m_retired[object].merge(counters);
+            }
+        });
+        for (auto iter = m_threads.begin(); iter != m_threads.end(); ++iter)
+        {
+            if (*iter == threadStats)
+            {
+                m_threads.erase(iter);
+                break;
+            }
+        }
+    }
+};
+
+inline ThreadStats::ThreadStats()
+{
+    StatsRegistry::instance().add(this);
+}
+
+inline ThreadStats::~ThreadStats()
+{
+    StatsRegistry::instance().retire(this);
+}
+
+inline ThreadStats &ThreadStats::local()
+{
+    //the slot table is too large for static thread local storage, it is allocated on first use
+    //(and owned by the thread local pointer holder)
+    struct Holder
+    {
+        ThreadStats *stats{new ThreadStats()};
+        ~Holder()
+        {
+            delete stats;
+        }
+    };
+    static thread_local Holder holder;
+    return *holder.stats;
+}
+
+//instrumentation policy recording into the thread local counters
+struct ContentionStats
+{
+    static uint64_t now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    static void acquired(const void *object, AcquirePath path)
+    {
+        auto &slot = ThreadStats::local().slot(object);
+        ThreadStats::increment(slot.acquisitions);
+        if (path == AcquirePath::FAST)
+        {
+            ThreadStats::increment(slot.fastPath);
+        }
+        else if (path == AcquirePath::SPIN)
+        {
+            ThreadStats::increment(slot.spinSuccess);
+        }
+    }
+
+    //returns the start of the wait, to be passed to unparked
+    static uint64_t parking(const void *object)
+    {
+        ThreadStats::increment(ThreadStats::local().slot(object).futexWaits);
+        return now();
+    }
+
+    static void unparked(const void *object, uint64_t start)
+    {
+        auto waited = now() - start;
+        auto &slot = ThreadStats::local().slot(object);
+        ThreadStats::increment(slot.waitTimeNs, waited);
+        ThreadStats::increment(slot.waitTime[Counters::bucket(waited)]);
+    }
+
+    static void waking(const void *object)
+    {
+        ThreadStats::increment(ThreadStats::local().slot(object).futexWakes);
+    }
+
+    static void spuriousWakeup(const void *object)
+    {
+        ThreadStats::increment(ThreadStats::local().slot(object).spuriousWakeups);
+    }
+};
+
+} // namespace instrumentation
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cstdint>
+
+//instrumentation points of the primitives
+//
+//define CP_CONTENTION_STATS to record per instance contention counters and wait time histograms
+//(see contention_stats.hpp), otherwise all probes are empty and optimized away
+//
+//define CP_TRACE to additionally record every probe as an event in a per thread ring buffer
+//(see trace.hpp, recording must also be enabled at runtime with Tracer::enable)
+#ifdef CP_CONTENTION_STATS
+#include "contention_stats.hpp"
+#endif
+
+#ifdef CP_TRACE
+#include "trace.hpp"
+#endif
+
+namespace instrumentation
+{
+
+#ifdef CP_CONTENTION_STATS
+using Stats = ContentionStats;
+#else
+//instrumentation policy doing nothing
+struct NoContentionStats
+{
+    static void acquired(const void *, AcquirePath)
+    {
+    }
+
+    static uint64_t parking(const void *)
+    {
+        return 0;
+    }
+
+    static void unparked(const void *, uint64_t)
+    {
+    }
+
+    static void waking(const void *)
+    {
+    }
+
+    static void spuriousWakeup(const void *)
+    {
+    }
+};
+
+using Stats = NoContentionStats;
+#endif
+
+inline void trace(const void *object, TraceEvent event)
+{
+#ifdef CP_TRACE
+    Tracer::record(object, event);
+#else
+    (void)object;
+    (void)event;
+#endif
+}
+
+//lock acquired or semaphore decremented
+inline void onAcquired(const void *object, AcquirePath path)
+{
+    Stats::acquired(object, path);
+    trace(object, TraceEvent::ACQUIRED);
+}
+
+//lock released
+inline void onReleased(const void *object)
+{
+    trace(object, TraceEvent::RELEASED);
+}
+
+//about to sleep (futex wait or wait on an inner semaphore), the result must be passed to onUnparked
+inline uint64_t onParking(const void *object)
+{
+    trace(object, TraceEvent::PARK);
+    return Stats::parking(object);
+}
+
+//returned from sleeping
+inline void onUnparked(const void *object, uint64_t parkToken)
+{
+    Stats::unparked(object, parkToken);
+    trace(object, TraceEvent::UNPARK);
+}
+
+//about to wake a sleeping thread (futex wake or post of an inner semaphore)
+inline void onWaking(const void *object)
+{
+    Stats::waking(object);
+    trace(object, TraceEvent::WAKE);
+}
+
+//woke up but could not acquire and has to sleep again
+inline void onSpuriousWakeup(const void *object)
+{
+    Stats::spuriousWakeup(object);
+}
+
+//post, signal or notify (whether or not anyone is waiting)
+inline void onSignal(const void *object)
+{
+    trace(object, TraceEvent::SIGNAL);
+}
+
+//entered a blocking wait of an event, condition variable or waitset
+inline void onWaitBegin(const void *object)
+{
+    trace(object, TraceEvent::WAIT_BEGIN);
+}
+
+//returned from a blocking wait
+inline void onWaitEnd(const void *object)
+{
+    trace(object, TraceEvent::WAIT_END);
+}
+
+} // namespace instrumentation
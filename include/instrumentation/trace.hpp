@@ -0,0 +1,220 @@
+#pragma once
+
+#include "types.hpp"
+#include "benchmark/tsc.hpp"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef CP_TRACE_CAPACITY
+#define CP_TRACE_CAPACITY 8192 //records per thread, must be a power of two
+#endif
+
+namespace instrumentation
+{
+
+//fixed size binary trace record (also the on disk format, see Tracer::write)
+struct TraceRecord
+{
+    uint64_t tsc;
+    uint64_t object;
+    uint32_t threadId;
+    uint32_t event;
+};
+
+static_assert(sizeof(TraceRecord) == 24, "trace record layout changed");
+
+//single producer ring buffer of one thread, the oldest records are overwritten
+//the words are relaxed atomics (plain stores on x86), so a concurrent snapshot is not a data race,
+//records overwritten during a snapshot are detected via the head counter and dropped (fences as in a seqlock)
+class TraceBuffer
+{
+public:
+    static constexpr uint64_t CAPACITY = CP_TRACE_CAPACITY;
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "trace capacity must be a power of two");
+
+    TraceBuffer() : m_threadId(static_cast<uint32_t>(syscall(SYS_gettid)))
+    {
+    }
+
+    void record(uint64_t tsc, const void *object, TraceEvent event)
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        //seqlock writer: the slot stores below must not become visible before the previous head publish,
+        //pairs with the acquire fence in snapshot (otherwise a torn record could pass its head check)
+        std::atomic_thread_fence(std::memory_order_release);
+        auto &slot = m_slots[head & (CAPACITY - 1)];
+        slot.tsc.store(tsc, std::memory_order_relaxed);
+        slot.object.store(reinterpret_cast<uint64_t>(object), std::memory_order_relaxed);
+        slot.threadAndEvent.store((uint64_t(m_threadId) << 32) | static_cast<uint32_t>(event), std::memory_order_relaxed);
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    //appends all records that are consistent at the end of the call
+    void snapshot(std::vector<TraceRecord> &records) const
+    {
+        auto head = m_head.load(std::memory_order_acquire);
+        auto first = head > CAPACITY ? head - CAPACITY : 0;
+
+        std::vector<TraceRecord> copied;
+        copied.reserve(head - first);
+        for (auto i = first; i < head; ++i)
+        {
+            auto &slot = m_slots[i & (CAPACITY - 1)];
+            auto threadAndEvent = slot.threadAndEvent.load(std::memory_order_relaxed);
+            copied.push_back({slot.tsc.load(std::memory_order_relaxed), slot.object.load(std::memory_order_relaxed),
+                              static_cast<uint32_t>(threadAndEvent >> 32), static_cast<uint32_t>(threadAndEvent)});
+        }
+
+        //the producer may have overwritten the oldest records while we copied them,
+        //and may be writing slot headAfter (i.e. record headAfter - CAPACITY) before it publishes headAfter + 1
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto headAfter = m_head.load(std::memory_order_relaxed);
+        auto valid = headAfter + 1 > CAPACITY ? headAfter + 1 - CAPACITY : 0;
+        for (auto i = first; i < head; ++i)
+        {
+            if (i >= valid)
+            {
+                records.push_back(copied[i - first]);
+            }
+        }
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> tsc{0};
+        std::atomic<uint64_t> object{0};
+        std::atomic<uint64_t> threadAndEvent{0};
+    };
+
+    std::atomic<uint64_t> m_head{0};
+    uint32_t m_threadId;
+    std::array<Slot, CAPACITY> m_slots;
+};
+
+//owns the buffers of all threads (the buffers of terminated threads are kept until reset())
+//tracing is compiled in with CP_TRACE and can additionally be switched on and off at runtime
+class Tracer
+{
+public:
+    static Tracer &instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    static void enable(bool enabled = true)
+    {
+        s_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool isEnabled()
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    //the hot path: one relaxed load if disabled, otherwise a TSC read and three stores
+    static void record(const void *object, TraceEvent event)
+    {
+        if (!isEnabled())
+        {
+            return;
+        }
+        local().record(now(), object, event);
+    }
+
+    //records of all threads ordered by time
+    std::vector<TraceRecord> snapshot()
+    {
+        std::vector<TraceRecord> records;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            for (auto &buffer : m_buffers)
+            {
+                buffer->snapshot(records);
+            }
+        }
+        std::stable_sort(records.begin(), records.end(),
+                         [](const TraceRecord &a, const TraceRecord &b) { return a.tsc < b.tsc; });
+        return records;
+    }
+
+    //binary trace file, convert it with trace_to_chrome
+    //format: "CPTRACE1", double ticks per ns, uint64_t record count, records
+    bool write(const std::string &path)
+    {
+        auto records = snapshot();
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        double ticksPerNs = bench::Tsc::ticksPerNs();
+        uint64_t count = records.size();
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write(reinterpret_cast<const char *>(&ticksPerNs), sizeof(ticksPerNs));
+        file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        file.write(reinterpret_cast<const char *>(records.data()), static_cast<std::streamsize>(count * sizeof(TraceRecord)));
+        return static_cast<bool>(file);
+    }
+
+    //drops the buffers of terminated threads
+    void reset()
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(),
+                                       [](const std::shared_ptr<TraceBuffer> &buffer) { return buffer.use_count() == 1; }),
+                        m_buffers.end());
+    }
+
+    static constexpr char MAGIC[8] = {'C', 'P', 'T', 'R', 'A', 'C', 'E', '1'};
+
+private:
+    static inline std::atomic<bool> s_enabled{false};
+
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> m_buffers; //shared with the owning thread
+
+    Tracer() = default;
+
+    static uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc(); //no fence, the order within a thread is given by the buffer
+#else
+        return bench::Tsc::now();
+#endif
+    }
+
+    static TraceBuffer &local()
+    {
+        static thread_local std::shared_ptr<TraceBuffer> buffer = instance().add();
+        return *buffer;
+    }
+
+    std::shared_ptr<TraceBuffer> add()
+    {
+        auto buffer = std::make_shared<TraceBuffer>();
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_buffers.push_back(buffer);
+        return buffer;
+    }
+};
+
+} // namespace instrumentation
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace instrumentation
+{
+
+//how an acquisition (lock, semaphore wait) succeeded
+enum class AcquirePath
+{
+    FAST, //first attempt
+    SPIN, //after spinning, but without sleeping
+    SLOW  //after sleeping (futex wait or inner semaphore)
+};
+
+//event types of trace records (values are part of the binary trace format, only append)
+enum class TraceEvent : uint32_t
+{
+    ACQUIRED = 1, //lock acquired, semaphore decremented
+    RELEASED,     //lock released
+    PARK,         //about to sleep
+    UNPARK,       //returned from sleeping
+    WAKE,         //about to wake a sleeping thread
+    SIGNAL,       //post, signal, notify
+    WAIT_BEGIN,   //entered a blocking wait (event, condition variable, waitset)
+    WAIT_END      //returned from a blocking wait
+};
+
+inline const char *toString(TraceEvent event)
+{
+    switch (event)
+    {
+    case TraceEvent::ACQUIRED:
+        return "acquired";
+    case TraceEvent::RELEASED:
+        return "released";
+    case TraceEvent::PARK:
+        return "park";
+    case TraceEvent::UNPARK:
+        return "unpark";
+    case TraceEvent::WAKE:
+        return "wake";
+    case TraceEvent::SIGNAL:
+        return "signal";
+    case TraceEvent::WAIT_BEGIN:
+        return "wait begin";
+    case TraceEvent::WAIT_END:
+        return "wait end";
+    }
+    return "unknown";
+}
+
+} // namespace instrumentation
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+#include "futex.hpp"
+
+//futex requests of io_uring (Linux 6.7), older kernel headers do not have them
+#ifndef IORING_OP_FUTEX_WAIT
+#define IORING_OP_FUTEX_WAIT 51
+#define IORING_OP_FUTEX_WAKE 52
+#define IORING_OP_FUTEX_WAITV 53
+#endif
+
+//minimal io_uring (raw syscalls, without liburing) and the preparation of futex requests,
+//i.e. a thread that waits for I/O completions in io_uring_enter can also wait for futex words of the primitives
+//(see uring_wait.hpp)
+namespace uring
+{
+
+constexpr uint32_t FUTEX2_SIZE_U32 = 0x02; //shared futex, as the other futex calls of the primitives
+
+//a ring with the submission and completion queues mapped into this process, owned by one thread
+class Ring
+{
+public:
+    //nullopt if io_uring is not available (e.g. before Linux 5.1 or disabled by the administrator)
+    static std::optional<Ring> create(uint32_t entries)
+    {
+        io_uring_params params{};
+        int fd = static_cast<int>(syscall(SYS_io_uring_setup, entries, &params));
+        if (fd < 0)
+        {
+            return std::nullopt;
+        }
+
+        Ring ring(fd);
+        if (!ring.map(params))
+        {
+            return std::nullopt;
+        }
+        return ring;
+    }
+
+    ~Ring()
+    {
+        unmap();
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+    }
+
+    Ring(const Ring &) = delete;
+
+    Ring(Ring &&other)
+        : m_fd(std::exchange(other.m_fd, -1)), m_sqMemory(std::exchange(other.m_sqMemory, nullptr)),
+          m_sqSize(other.m_sqSize), m_cqMemory(std::exchange(other.m_cqMemory, nullptr)), m_cqSize(other.m_cqSize),
+          m_sqes(std::exchange(other.m_sqes, nullptr)), m_sqesSize(other.m_sqesSize), m_sq(other.m_sq), m_cq(other.m_cq),
+          m_sqTail(other.m_sqTail)
+    {
+    }
+
+    int fd() const
+    {
+        return m_fd;
+    }
+
+    //a zeroed submission entry, nullptr if the submission queue is full (submit first)
+    io_uring_sqe *sqe()
+    {
+        auto head = m_sq.head->load(std::memory_order_acquire);
+        if (m_sqTail - head >= m_sq.entries)
+        {
+            return nullptr;
+        }
+        auto index = m_sqTail & m_sq.mask;
+        m_sq.array[index] = index;
+        ++m_sqTail;
+
+        auto sqe = &m_sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    //submits the prepared entries and waits until at least minComplete completions are available,
+    //returns the number of submitted entries or -errno (e.g. -EINTR)
+    int submit(uint32_t minComplete = 0)
+    {
+        auto toSubmit = m_sqTail - m_sq.tail->load(std::memory_order_relaxed);
+        m_sq.tail->store(m_sqTail, std::memory_order_release);
+
+        uint32_t flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+        auto result = syscall(SYS_io_uring_enter, m_fd, toSubmit, minComplete, flags, nullptr, 0);
+        return result < 0 ? -errno : static_cast<int>(result);
+    }
+
+    //calls f(const io_uring_cqe &) for each available completion and removes them, returns their number
+    template <typename F>
+    size_t forEachCompletion(F f)
+    {
+        auto head = m_cq.head->load(std::memory_order_relaxed);
+        auto tail = m_cq.tail->load(std::memory_order_acquire);
+        size_t count = 0;
+        for (; head != tail; ++head, ++count)
+        {
+            f(m_cq.cqes[head & m_cq.mask]);
+        }
+        m_cq.head->store(head, std::memory_order_release);
+        return count;
+    }
+
+private:
+    struct SubmissionQueue
+    {
+        std::atomic<uint32_t> *head{nullptr};
+        std::atomic<uint32_t> *tail{nullptr};
+        uint32_t mask{0};
+        uint32_t entries{0};
+        uint32_t *array{nullptr};
+    };
+
+    struct CompletionQueue
+    {
+        std::atomic<uint32_t> *head{nullptr};
+        std::atomic<uint32_t> *tail{nullptr};
+        uint32_t mask{0};
+        io_uring_cqe *cqes{nullptr};
+    };
+
+    int m_fd{-1};
+    void *m_sqMemory{nullptr};
+    size_t m_sqSize{0};
+    void *m_cqMemory{nullptr}; //the same mapping as the submission queue with IORING_FEAT_SINGLE_MMAP
+    size_t m_cqSize{0};
+    io_uring_sqe *m_sqes{nullptr};
+    size_t m_sqesSize{0};
+    SubmissionQueue m_sq;
+    CompletionQueue m_cq;
+    uint32_t m_sqTail{0}; //local tail, published by submit
+
+    explicit Ring(int fd) : m_fd(fd)
+    {
+    }
+
+    bool map(const io_uring_params &params)
+    {
+        m_sqSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        m_cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMapping)
+        {
+            m_sqSize = m_cqSize = std::max(m_sqSize, m_cqSize);
+        }
+
+        m_sqMemory = mapRegion(m_sqSize, IORING_OFF_SQ_RING);
+        m_cqMemory = singleMapping ? m_sqMemory : mapRegion(m_cqSize, IORING_OFF_CQ_RING);
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = static_cast<io_uring_sqe *>(mapRegion(m_sqesSize, IORING_OFF_SQES));
+        if (!m_sqMemory || !m_cqMemory || !m_sqes)
+        {
+            return false;
+        }
+
+        auto sq = static_cast<char *>(m_sqMemory);
+        m_sq.head = reinterpret_cast<std::atomic<uint32_t> *>(sq + params.sq_off.head);
+        m_sq.tail = reinterpret_cast<std::atomic<uint32_t> *>(sq + params.sq_off.tail);
+        m_sq.mask = *reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+        m_sq.entries = params.sq_entries;
+        m_sq.array = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+        m_sqTail = m_sq.tail->load(std::memory_order_relaxed);
+
+        auto cq = static_cast<char *>(m_cqMemory);
+        m_cq.head = reinterpret_cast<std::atomic<uint32_t> *>(cq + params.cq_off.head);
+        m_cq.tail = reinterpret_cast<std::atomic<uint32_t> *>(cq + params.cq_off.tail);
+        m_cq.mask = *reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+        m_cq.cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    void *mapRegion(size_t size, uint64_t offset)
+    {
+        auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, static_cast<off_t>(offset));
+        return memory == MAP_FAILED ? nullptr : memory;
+    }
+
+    void unmap()
+    {
+        if (m_sqes)
+        {
+            munmap(m_sqes, m_sqesSize);
+        }
+        if (m_cqMemory && m_cqMemory != m_sqMemory)
+        {
+            munmap(m_cqMemory, m_cqSize);
+        }
+        if (m_sqMemory)
+        {
+            munmap(m_sqMemory, m_sqSize);
+        }
+    }
+};
+
+//completes (res 0) when the word is woken, or at once with -EAGAIN if *futexWord != expected at submission
+inline void prepareFutexWait(io_uring_sqe *sqe, int32_t *futexWord, int32_t expected, uint64_t userData)
+{
+    sqe->opcode = IORING_OP_FUTEX_WAIT;
+    sqe->fd = FUTEX2_SIZE_U32;
+    sqe->addr = reinterpret_cast<uintptr_t>(futexWord);
+    sqe->off = static_cast<uint32_t>(expected);
+    sqe->addr3 = FUTEX_BITSET_MATCH_ANY;
+    sqe->user_data = userData;
+}
+
+//completes with the number of woken waiters
+inline void prepareFutexWake(io_uring_sqe *sqe, int32_t *futexWord, int32_t numToWake, uint64_t userData)
+{
+    sqe->opcode = IORING_OP_FUTEX_WAKE;
+    sqe->fd = FUTEX2_SIZE_U32;
+    sqe->addr = reinterpret_cast<uintptr_t>(futexWord);
+    sqe->off = static_cast<uint32_t>(numToWake);
+    sqe->addr3 = FUTEX_BITSET_MATCH_ANY;
+    sqe->user_data = userData;
+}
+
+//completes with the number of bytes read (offset is ignored for pipes and sockets)
+inline void prepareRead(io_uring_sqe *sqe, int fd, void *buffer, uint32_t size, uint64_t offset, uint64_t userData)
+{
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uintptr_t>(buffer);
+    sqe->len = size;
+    sqe->off = offset;
+    sqe->user_data = userData;
+}
+
+//completes with -ETIME after the (relative) timeout, which must stay valid until it is submitted
+inline void prepareTimeout(io_uring_sqe *sqe, __kernel_timespec *timeout, uint64_t userData)
+{
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uintptr_t>(timeout);
+    sqe->len = 1;
+    sqe->user_data = userData;
+}
+
+//cancels the pending requests with user data target (they complete with -ECANCELED)
+inline void prepareCancel(io_uring_sqe *sqe, uint64_t target, uint64_t userData)
+{
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target;
+    sqe->user_data = userData;
+}
+
+//runtime probe (once): io_uring is available and supports IORING_OP_FUTEX_WAIT
+inline bool futexSupported()
+{
+    static const bool supported = [] {
+        auto ring = Ring::create(2);
+        if (!ring)
+        {
+            return false;
+        }
+        constexpr uint32_t MAX_OPS = 256;
+        alignas(io_uring_probe) char buffer[sizeof(io_uring_probe) + MAX_OPS * sizeof(io_uring_probe_op)] = {};
+        auto probe = reinterpret_cast<io_uring_probe *>(buffer);
+        if (syscall(SYS_io_uring_register, ring->fd(), IORING_REGISTER_PROBE, probe, MAX_OPS) != 0)
+        {
+            return false; //before Linux 5.6, no futex requests anyway
+        }
+        return probe->ops_len > IORING_OP_FUTEX_WAIT && (probe->ops[IORING_OP_FUTEX_WAIT].flags & IO_URING_OP_SUPPORTED);
+    }();
+    return supported;
+}
+
+} // namespace uring
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "instrumentation/probes.hpp"
+
 #include <atomic>
 
 template <typename Semaphore, int MAX_SPIN = 100000>
@@ -51,6 +53,7 @@ private:
             if ((oldCount > 0) && m_count.compare_exchange_strong(oldCount, oldCount - 1, std::memory_order_acquire))
             {
                 increaseSpin(); //we were successful while spinning, increase the spin time
+                instrumentation::onAcquired(this, instrumentation::AcquirePath::SPIN);
                 return;
             }
             std::atomic_signal_fence(std::memory_order_acquire); //prevent reordering
@@ -59,8 +62,13 @@ private:
         if (oldCount <= 0)
         {
             decreaseSpin(); //we were not successful while spinning, decrease the spin time
+            auto parkToken = instrumentation::onParking(this);
             m_semaphore.wait();
+            instrumentation::onUnparked(this, parkToken);
+            instrumentation::onAcquired(this, instrumentation::AcquirePath::SLOW);
+            return;
         }
+        instrumentation::onAcquired(this, instrumentation::AcquirePath::SPIN); //count was incremented during the fetch_sub
     }
 
 public:
@@ -79,7 +87,9 @@ public:
         if (!tryWait())
         {
             waitWithAdaptiveSpinning();
+            return;
         }
+        instrumentation::onAcquired(this, instrumentation::AcquirePath::FAST);
     }
 
     void post(int count = 1)
@@ -88,6 +98,7 @@ public:
         int toRelease = -oldCount < count ? -oldCount : count;
         if (toRelease > 0)
         {
+            instrumentation::onWaking(this);
             m_semaphore.post(toRelease);
         }
     }
@@ -1,18 +1,21 @@
 #pragma once
 
-#include <linux/futex.h>
-#include <sys/syscall.h>
-#include <unistd.h>
+#include "futex.hpp"
+#include "instrumentation/probes.hpp"
 
 #include <atomic>
 
-//todo: interprocess lock with futex word relative to this
+//the futex word is the lock state itself (not a stored pointer), i.e. the lock can be placed in shared memory
+//and used by several processes (the futex calls are not process private)
 //adaptive spinning?
 
 class Lock
 {
 
 private:
+    template <typename T>
+    friend struct WaitAnySource; //see wait_any.hpp
+
     enum State : int32_t
     {
         UNLOCKED = 0, //unlocked, i.e. no one has the lock
@@ -25,11 +28,16 @@ private:
     //must be 32 bit int for futex to work (make this explicit int32_t)
     std::atomic<int32_t> state{UNLOCKED};
 
-    //note: it is fairly obvious how to make this usable as interprocess mutex:
-    //the futex word must be available in different address space,
-    // i.e. the atomic must be shared via shared memory between processes
-    // a semaphore implementation using a futex can do this as well
-    int32_t *futexWord;
+    //note: the memory has to be interpretable this way, the standard guarantees this for atomic types
+    // that are small enough to support hardware atomic operations without implicit mutex
+    //i.e. an atomic stores just raw memory for its data and nothing else
+    //(or at least it has to start with this raw memory)
+    //this is necessary to use it as the futex word to wait on
+    //it is computed from this on each use, a stored pointer would be invalid in other address spaces
+    int32_t *futexWord()
+    {
+        return reinterpret_cast<int32_t *>(&state);
+    }
 
     int compareExchangeState(int32_t expected, int32_t desired)
     {
@@ -45,27 +53,22 @@ private:
     void sleepIfContested()
     {
         //we only sleep on the futexWord if the lock is contested
-        //the last 3 arguments are unused by the FUTEX_WAIT call
-        syscall(SYS_futex, futexWord, FUTEX_WAIT, CONTESTED, 0, 0, 0);
+        auto parkToken = instrumentation::onParking(this);
+        futex::wait(futexWord(), CONTESTED);
+        instrumentation::onUnparked(this, parkToken);
     }
 
     void wakeOne()
     {
         //we wake 1 thread waiting on the futexWord if there is one waiting, which the API call can determine
-        //the last 3 arguments are unused by the FUTEX_WAKE call
-        syscall(SYS_futex, futexWord, 1, 0, 0, 0);
+        instrumentation::onWaking(this);
+        futex::wake(futexWord(), 1);
     }
 
 public:
     Lock(uint32_t maxSpinIterations = 1)
         : MAX_SPINNING_ACQUIRE_ITERATIONS(maxSpinIterations > 0 ? maxSpinIterations : 1)
     {
-        //note: the memory has to be interpretable this way, the standard guarantees this for atomic types
-        // that are small enough to support hardware atomic operations without implicit mutex
-        //i.e. an atomic stores just raw memory for its data and nothing else
-        //(or at least it has to start with this raw memory)
-        //this is necessary to use it as the futex word to wait on
-        futexWord = reinterpret_cast<int *>(&state);
     }
 
     Lock(const Lock &) = delete;
@@ -73,12 +76,15 @@ public:
 
     void lock()
     {
+        bool slept = false;
+
         //try to acquire the lock by spinning
         for (uint32_t i = 0; i < MAX_SPINNING_ACQUIRE_ITERATIONS; ++i)
         {
             auto knownState = compareExchangeState(UNLOCKED, LOCKED);
             if (knownState == UNLOCKED)
             {
+                instrumentation::onAcquired(this, i == 0 ? instrumentation::AcquirePath::FAST : instrumentation::AcquirePath::SPIN);
                 return;
             }
             else if (knownState == CONTESTED)
@@ -86,6 +92,7 @@ public:
                 //contested, do not try to spin any more and sleep instead
                 //(promotes fairness with respect to threads trying to acquire the lock)
                 sleepIfContested();
+                slept = true;
                 break;
             }
             //it is only locked and not contested by others, try again for some fixed number of iterations
@@ -106,12 +113,21 @@ public:
 
             //note that we also do not sleep when someone sets it back to UNLOCKED before the exchange
             //and just set it to CONTESTED (false positive) and return, having acquired the lock
+            if (slept)
+            {
+                //we were woken up (or the futex returned) but someone else has the lock
+                instrumentation::onSpuriousWakeup(this);
+            }
             sleepIfContested();
+            slept = true;
         }
+
+        instrumentation::onAcquired(this, slept ? instrumentation::AcquirePath::SLOW : instrumentation::AcquirePath::SPIN);
     }
 
     void unlock()
     {
+        instrumentation::onReleased(this);
         //change the lock state back to unlocked and wake someone if it was contested
         if (exchangeState(UNLOCKED) == CONTESTED)
         {
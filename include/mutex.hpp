@@ -1,6 +1,7 @@
 #pragma once
 
 #include <semaphore.hpp>
+#include "instrumentation/probes.hpp"
 #include <atomic>
 
 //a simple mutex (without spinlock optimization) based on our semaphore implementation
@@ -24,14 +25,21 @@ public:
     {
         if (contenders.fetch_add(1, std::memory_order_acquire) > 0)
         {
+            auto parkToken = instrumentation::onParking(this);
             semaphore.wait();
+            instrumentation::onUnparked(this, parkToken);
+            instrumentation::onAcquired(this, instrumentation::AcquirePath::SLOW);
+            return;
         }
+        instrumentation::onAcquired(this, instrumentation::AcquirePath::FAST);
     }
 
     void unlock()
     {
+        instrumentation::onReleased(this);
         if (contenders.fetch_sub(1, std::memory_order_release) > 1)
         {
+            instrumentation::onWaking(this);
             semaphore.post();
         }
     }
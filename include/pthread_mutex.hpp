@@ -0,0 +1,39 @@
+#pragma once
+
+#include <pthread.h>
+
+#include <exception>
+
+//light wrapper for benchmark, no error checking
+class PthreadMutex
+{
+public:
+    PthreadMutex()
+    {
+        if (pthread_mutex_init(&mutex, nullptr) != 0)
+        {
+            throw(std::exception());
+        }
+    }
+
+    ~PthreadMutex()
+    {
+        pthread_mutex_destroy(&mutex);
+    }
+
+    PthreadMutex(const PthreadMutex &) = delete;
+    PthreadMutex(PthreadMutex &&) = delete;
+
+    void lock()
+    {
+        pthread_mutex_lock(&mutex);
+    }
+
+    void unlock()
+    {
+        pthread_mutex_unlock(&mutex);
+    }
+
+private:
+    pthread_mutex_t mutex;
+};
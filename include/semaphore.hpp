@@ -1,10 +1,10 @@
 #pragma once
 
-#include <linux/futex.h>
-#include <sys/syscall.h>
-#include <unistd.h>
+#include "futex.hpp"
+#include "instrumentation/probes.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <limits>
 
 //actually it is a bounded semahore (i.e. with a maximum value), but the bound is not configurable yet (which is easy to do)
@@ -17,7 +17,6 @@ public:
         {
             value = 0;
         }
-        futexWord = reinterpret_cast<int *>(&value); //todo: need the correct type and size (futex requires int)
     }
 
     ~Semaphore()
@@ -48,6 +47,7 @@ public:
     {
         if (tryWait())
         {
+            instrumentation::onAcquired(this, instrumentation::AcquirePath::FAST);
             return;
         }
 
@@ -59,9 +59,55 @@ public:
         do
         {
             sleepIfValueIsZero();
-        } while (!tryWait());
+            if (tryWait())
+            {
+                break;
+            }
+            instrumentation::onSpuriousWakeup(this); //woken up (or value changed) but someone else was faster
+        } while (true);
 
         waitCount.fetch_sub(1, std::memory_order_acq_rel);
+        instrumentation::onAcquired(this, instrumentation::AcquirePath::SLOW);
+    }
+
+    //returns false if the value was still 0 at the deadline
+    bool waitUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        if (tryWait())
+        {
+            instrumentation::onAcquired(this, instrumentation::AcquirePath::FAST);
+            return true;
+        }
+
+        waitCount.fetch_add(1, std::memory_order_acq_rel);
+
+        bool acquired = false;
+        do
+        {
+            bool timedOut = !sleepIfValueIsZero(deadline);
+            if (tryWait())
+            {
+                acquired = true;
+                break;
+            }
+            if (timedOut)
+            {
+                break;
+            }
+            instrumentation::onSpuriousWakeup(this);
+        } while (true);
+
+        waitCount.fetch_sub(1, std::memory_order_acq_rel);
+        if (acquired)
+        {
+            instrumentation::onAcquired(this, instrumentation::AcquirePath::SLOW);
+        }
+        return acquired;
+    }
+
+    bool waitFor(std::chrono::nanoseconds timeout)
+    {
+        return waitUntil(std::chrono::steady_clock::now() + timeout);
     }
 
     size_t post(size_t increment = 1)
@@ -105,6 +151,7 @@ public:
         } while (notIncremented);
 
         //we finished the increment (or returned because value is already MAX_VALUE)
+        instrumentation::onSignal(this);
 
         //is someone waiting?
         //note: not needed if the futex works, but we want to avoid a syscall if possible
@@ -121,21 +168,42 @@ public:
     }
 
 private:
+    template <typename T>
+    friend struct WaitAnySource; //see wait_any.hpp
+
     std::atomic<int> value;
     std::atomic<int> waitCount{0};
 
     //we could easily make this max limit configurable later, e.g. as template parameter or member set during construction
     static constexpr int MAX_VALUE = std::numeric_limits<int>::max();
 
-    int *futexWord;
+    static_assert(sizeof(std::atomic<int>) == sizeof(int32_t), "the value is used as futex word");
+
+    //computed from this on each use (instead of a stored pointer), i.e. the semaphore can be placed in shared memory
+    int32_t *futexWord()
+    {
+        return reinterpret_cast<int32_t *>(&value);
+    }
 
     void sleepIfValueIsZero()
     {
-        syscall(SYS_futex, futexWord, FUTEX_WAIT, 0, 0, 0, 0);
+        auto parkToken = instrumentation::onParking(this);
+        futex::wait(futexWord(), 0);
+        instrumentation::onUnparked(this, parkToken);
+    }
+
+    //false if the deadline has passed
+    bool sleepIfValueIsZero(std::chrono::steady_clock::time_point deadline)
+    {
+        auto parkToken = instrumentation::onParking(this);
+        auto result = futex::waitUntil(futexWord(), 0, deadline);
+        instrumentation::onUnparked(this, parkToken);
+        return result;
     }
 
     void wake(size_t numToWake)
     {
-        syscall(SYS_futex, futexWord, numToWake, 0, 0, 0);
+        instrumentation::onWaking(this);
+        futex::wake(futexWord(), numToWake < static_cast<size_t>(MAX_VALUE) ? static_cast<int32_t>(numToWake) : MAX_VALUE);
     }
 };
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+#include <vector>
+
+//fixed capacity container with stable indices (and addresses) and O(1) emplace, remove and lookup
+//
+//free slots form an intrusive stack (the first emplaces return 0, 1, 2, ...),
+//every slot has a generation that changes on removal, i.e. (index, generation) detects stale references,
+//and the indices of the live elements are kept densely packed for iteration (removal swaps with the last one)
+//
+//not thread safe
+template <typename T, typename Index = uint32_t>
+class SlotMap
+{
+public:
+    using index_t = Index;
+    using generation_t = uint32_t;
+
+    static constexpr index_t NO_INDEX = static_cast<index_t>(-1);
+
+    SlotMap(size_t capacity) : m_capacity(capacity), m_storage(new Storage[capacity]), m_slots(capacity)
+    {
+        m_dense.reserve(capacity);
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            m_slots[i].link = i + 1 < capacity ? static_cast<index_t>(i + 1) : NO_INDEX;
+        }
+        m_free = capacity > 0 ? 0 : NO_INDEX;
+    }
+
+    ~SlotMap()
+    {
+        for (auto index : m_dense)
+        {
+            element(index).~T();
+        }
+    }
+
+    SlotMap(const SlotMap &) = delete;
+    SlotMap(SlotMap &&) = delete;
+
+    template <typename... Args>
+    std::optional<index_t> emplace(Args &&... args)
+    {
+        if (m_free == NO_INDEX)
+        {
+            return std::nullopt;
+        }
+        auto index = m_free;
+        auto &slot = m_slots[index];
+
+        new (&m_storage[index]) T(std::forward<Args>(args)...);
+
+        m_free = slot.link;
+        slot.used = true;
+        slot.link = static_cast<index_t>(m_dense.size());
+        m_dense.push_back(index); //does not allocate, capacity is reserved
+        return index;
+    }
+
+    bool remove(index_t index)
+    {
+        if (!contains(index))
+        {
+            return false;
+        }
+        auto &slot = m_slots[index];
+        element(index).~T(); //keep the memory but destroy the content
+
+        //move the last live index into the gap
+        auto last = m_dense.back();
+        m_dense[slot.link] = last;
+        m_slots[last].link = slot.link;
+        m_dense.pop_back();
+
+        slot.used = false;
+        ++slot.generation;
+        slot.link = m_free;
+        m_free = index;
+        return true;
+    }
+
+    bool contains(index_t index) const
+    {
+        return index < m_capacity && m_slots[index].used;
+    }
+
+    //false if the element the generation was taken from was removed (even if the slot is used again)
+    bool contains(index_t index, generation_t generation) const
+    {
+        return contains(index) && m_slots[index].generation == generation;
+    }
+
+    generation_t generation(index_t index) const
+    {
+        return m_slots[index].generation;
+    }
+
+    //precondition: contains(index)
+    T &operator[](index_t index)
+    {
+        return element(index);
+    }
+
+    //calls f(index, element) for the live elements only
+    //(f must not emplace or remove)
+    template <typename F>
+    void forEach(F f)
+    {
+        for (auto index : m_dense)
+        {
+            f(index, element(index));
+        }
+    }
+
+    //indices of the live elements (in no particular order)
+    const std::vector<index_t> &indices() const
+    {
+        return m_dense;
+    }
+
+    size_t size() const
+    {
+        return m_dense.size();
+    }
+
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+private:
+    struct Storage
+    {
+        alignas(T) unsigned char data[sizeof(T)];
+    };
+
+    struct Slot
+    {
+        generation_t generation{0};
+        bool used{false};
+        index_t link{NO_INDEX}; //free: next free slot, used: position in m_dense
+    };
+
+    size_t m_capacity;
+    std::unique_ptr<Storage[]> m_storage;
+    std::vector<Slot> m_slots;
+    std::vector<index_t> m_dense;
+    index_t m_free{NO_INDEX};
+
+    T &element(index_t index)
+    {
+        return *std::launder(reinterpret_cast<T *>(&m_storage[index]));
+    }
+};
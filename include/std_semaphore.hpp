@@ -0,0 +1,38 @@
+#pragma once
+
+#if __cplusplus < 202002L
+#error "std_semaphore.hpp requires C++20 (std::counting_semaphore)"
+#endif
+
+#include <semaphore>
+#include <cstddef>
+
+//light wrapper for benchmark, adapts std::counting_semaphore to the interface of Semaphore
+class StdSemaphore
+{
+public:
+    StdSemaphore(int initialValue = 0) : sem(initialValue >= 0 ? initialValue : 0)
+    {
+    }
+
+    StdSemaphore(const StdSemaphore &) = delete;
+    StdSemaphore(StdSemaphore &&) = delete;
+
+    bool tryWait()
+    {
+        return sem.try_acquire();
+    }
+
+    void wait()
+    {
+        sem.acquire();
+    }
+
+    void post(int count = 1)
+    {
+        sem.release(count);
+    }
+
+private:
+    std::counting_semaphore<> sem;
+};
@@ -10,8 +10,7 @@
 #include <time.h>
 #include <iostream>
 
-#include <mutex>      //only for lock_guard which can easily be implemented on its own
-#include <functional> //for the predicate
+#include <mutex> //only for lock_guard which can easily be implemented on its own
 
 //general idea of timed_wait
 
@@ -36,42 +35,21 @@
 class TimeoutConditionVariable
 {
 private:
+    //lives on the stack of the waiting thread, the timer is a pooled entry of the timer service
     struct WaitNode
     {
+        WaitNode(TimeoutConditionVariable *condVar) : timer([=] { condVar->notify(this); })
+        {
+        }
+
         WaitNode *prev{nullptr};
         WaitNode *next{nullptr};
         Semaphore semaphore;
-        Timer *timer{nullptr};
-
-        bool createTimer(TimeoutConditionVariable *condVar, std::chrono::nanoseconds &waitTime)
-        {
-            auto callback = [=] { condVar->notify(this); };
-
-            //the timer should fire and delete itself afterwards (seems hard to do it
-            //externally, because we cannot be sure whether the callback was already initiated
-            //and the callback requires access to the Timer object
-
-            timer = new Timer(callback, true);
-            if (timer)
-            {
-                timer->arm(waitTime);
-                return true;
-            }
-
-            return false;
-        }
+        Timer timer;
 
         bool timedOut()
         {
-            if (timer)
-            {
-                return timer->timedOut();
-            }
-            return false;
-        }
-
-        ~WaitNode()
-        {
+            return timer.timedOut();
         }
     };
 
@@ -144,9 +122,9 @@ private:
 
         if (nodeExistsInList(node))
         {
-            //we hold the lock so node will still be there
-            node->semaphore.post();
+            //we hold the lock so node will still be there, it is unlinked before the waiter can wake up
             removeWaitNode(node);
+            node->semaphore.post();
         }
     }
 
@@ -166,17 +144,18 @@ public:
     TimeoutConditionVariable(TimeoutConditionVariable &&) = delete;
 
     //the other variants without timer are straightforward if this one works
-    template <typename LockType>
-    bool wait(LockType &lock, std::function<bool(void)> predicate, std::chrono::nanoseconds waitTime)
+    template <typename LockType, typename Predicate>
+    bool wait(LockType &lock, Predicate predicate, std::chrono::nanoseconds waitTime)
     {
         if (predicate())
         {
             return true; // we still hold the lock (if we held it upon entering as required, but this is not enforcable)
         }
 
-        auto node = new WaitNode;
+        WaitNode waitNode(this);
+        auto node = &waitNode;
 
-        if (!node || !node->createTimer(this, waitTime))
+        if (!node->timer.arm(waitTime))
         {
             //we could not create a timer and cannot fullfill the contract without it (could block indefinitely)
             //we therefore return (todo: can be enhanced with some expected, to signal the error)
@@ -207,14 +186,9 @@ public:
 
         } while (!predicateResult); //if there is a spurious wake up we release the lock and wait again
 
-        //the node was already removed from the list by the notify or the timeout call, so it can be safely deleted
-        //even if the other still fires, it will find no node in the list and thus not work on deleted data
-        //TODO: but, in principle, it seems it could work on a newly created node on the heap with the same address,
-        //which would not be correct (kind of an ABA problem with pointers...)
-        //could give nodes ascending ids
-
-        std::cout << "deleting node " << node << std::endl;
-        delete node;
+        //the node was already removed from the list by the notify or the timeout call,
+        //the timer is disarmed (or its callback finished) when the node is destroyed, so it cannot work on a
+        //node that no longer exists (or a new one at the same address)
 
         //do we want to hold the lock even if predicate was false (and we timed out?)
         //note that when we timedOut and the predicate was true we still return true...
@@ -222,37 +196,29 @@ public:
         return predicateResult; //false: timeout AND predicate is false, true otherwise
     }
 
+    //the node lives on the stack of the waiter, i.e. it must not be touched after the post
+    //(the waiter may return and destroy it), so it is disarmed and unlinked before
     void notifyOne()
     {
+        std::lock_guard<Lock> guard(waitListLock);
         if (waitList)
         {
-            waitList->semaphore.post();
-            std::lock_guard<Lock> guard(waitListLock);
-
-            if (waitList->timer)
-            {
-                waitList->timer->disarm();
-            }
-
+            auto node = waitList;
+            node->timer.disarm();
             removeFirstWaitNode();
+            node->semaphore.post();
         }
     }
 
     void notifyAll()
     {
-        if (waitList)
+        std::lock_guard<Lock> guard(waitListLock);
+        while (waitList)
         {
-            std::lock_guard<Lock> guard(waitListLock);
-            while (waitList)
-            {
-                if (waitList->timer)
-                {
-                    waitList->timer->disarm();
-                }
-
-                waitList->semaphore.post();
-                removeFirstWaitNode();
-            }
+            auto node = waitList;
+            node->timer.disarm();
+            removeFirstWaitNode();
+            node->semaphore.post();
         }
     }
 };
\ No newline at end of file
@@ -0,0 +1,544 @@
+#pragma once
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+//runs the callbacks of many timers on one thread, instead of one kernel timer (and one handler thread) per timer
+//
+//the pending timers are kept in a hierarchical timing wheel: level L has 64 slots of 64^L ticks each,
+//a timer is stored at the lowest level whose slot lies in the same 64^(L+1) tick window as the current tick
+//and moves down (cascades) when its slot is reached, i.e. arm and disarm are O(1) (intrusive lists of pool entries)
+//and each timer is touched at most once per level
+//
+//the service thread sleeps on a timerfd that is programmed (absolute, CLOCK_MONOTONIC) to the next tick with
+//work to do (an expiration or a cascade), callbacks are called on the service thread without holding the lock,
+//so they may arm or disarm timers (but should be short, they delay all other timers)
+//
+//periodic timers are scheduled relative to their previous deadline (not to the time the callback ran),
+//i.e. they do not drift, periods missed entirely (e.g. by a long callback) are skipped
+//a timer with slack may expire anywhere in [deadline, deadline + slack], the service picks the tick with the most
+//trailing zero bits in this window, so timers with overlapping windows tend to share a tick (and a wake up)
+//
+//timers are taken from a fixed capacity pool and addressed by handles consisting of pool index and generation,
+//the generation changes when a timer is returned to the pool, i.e. stale handles are rejected
+class TimerService
+{
+public:
+    using Callback = std::function<void(void)>; //small callables (e.g. one pointer) are stored without allocation
+    using handle_t = uint64_t;                  //generation << 32 | pool index
+    using clock_t = std::chrono::steady_clock;  //CLOCK_MONOTONIC on linux
+
+    static constexpr handle_t INVALID_HANDLE = std::numeric_limits<handle_t>::max();
+    static constexpr uint32_t DEFAULT_CAPACITY = 1 << 17;
+
+    //definitive state of the callback when disarming (under the lock of the service)
+    enum class Status
+    {
+        CANCELLED, //was armed, the callback will not run
+        NOT_ARMED, //was not armed (never or already disarmed), the callback will not run
+        RUNNING,   //the callback is running right now (use release to wait for it)
+        HAS_RUN,   //the callback has run since the timer was last armed
+        INVALID    //stale or invalid handle
+    };
+
+    //capacity is the maximum number of timers (armed or not), resolution the length of one tick
+    TimerService(uint32_t capacity = DEFAULT_CAPACITY,
+                 std::chrono::nanoseconds resolution = std::chrono::milliseconds(1))
+        : m_resolution(resolution.count() > 0 ? resolution : std::chrono::nanoseconds(1)), m_start(clock_t::now()),
+          m_entries(capacity < NO_INDEX ? capacity : NO_INDEX - 1)
+    {
+        m_heads.fill(NO_INDEX);
+        m_occupied.fill(0);
+
+        index_t size = static_cast<index_t>(m_entries.size());
+        for (index_t i = 0; i < size; ++i)
+        {
+            m_entries[i].next = i + 1 < size ? i + 1 : NO_INDEX;
+        }
+        m_free = size > 0 ? 0 : NO_INDEX;
+
+        //todo: can fail (no more file descriptors), the service would never fire in this case
+        m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        m_thread = std::thread(&TimerService::run, this);
+    }
+
+    ~TimerService()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_stop = true;
+            program(m_now); //wake the service thread immediately
+        }
+        m_thread.join();
+        close(m_timerFd);
+    }
+
+    TimerService(const TimerService &) = delete;
+    TimerService(TimerService &&) = delete;
+
+    //service shared by all timers that are not given a service explicitly
+    static TimerService &instance()
+    {
+        static TimerService service;
+        return service;
+    }
+
+    //takes a timer from the pool, nullopt if the pool is exhausted
+    std::optional<handle_t> create(const Callback &callback)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_free == NO_INDEX)
+        {
+            return std::nullopt;
+        }
+        auto index = m_free;
+        auto &entry = m_entries[index];
+        m_free = entry.next;
+
+        entry.callback = callback;
+        entry.state = State::IDLE;
+        entry.prev = entry.next = NO_INDEX;
+        entry.releaseAfterRun = false;
+        return toHandle(index, entry.generation);
+    }
+
+    //(re)arms the timer to expire after delay (rounded up to full ticks) and then every period (if not 0),
+    //each expiration may be delayed by up to slack to share a tick with other timers, false for invalid handles
+    bool arm(handle_t handle, std::chrono::nanoseconds delay,
+             std::chrono::nanoseconds period = std::chrono::nanoseconds(0),
+             std::chrono::nanoseconds slack = std::chrono::nanoseconds(0))
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto index = toIndex(handle);
+        if (index == NO_INDEX)
+        {
+            return false;
+        }
+        auto &entry = m_entries[index];
+        if (entry.armed)
+        {
+            unlink(index);
+        }
+
+        entry.deadline = clock_t::now() - m_start + delay;
+        entry.period = period.count() > 0 ? period : std::chrono::nanoseconds(0);
+        entry.slack = slack.count() > 0 ? slack : std::chrono::nanoseconds(0);
+        if (entry.state != State::RUNNING)
+        {
+            entry.state = State::ARMED;
+        }
+        schedule(index);
+        return true;
+    }
+
+    //stops the timer if it is armed, the result tells whether the callback will still run
+    Status disarm(handle_t handle)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto index = toIndex(handle);
+        if (index == NO_INDEX)
+        {
+            return Status::INVALID;
+        }
+        return disarm(index);
+    }
+
+    bool isArmed(handle_t handle)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto index = toIndex(handle);
+        return index != NO_INDEX && m_entries[index].armed;
+    }
+
+    //disarms the timer and returns it to the pool (the handle becomes invalid), waits for a running callback to finish
+    //(unless called from the callback itself, the entry is returned after the callback in this case)
+    //returns the state of the callback at the time of the call (RUNNING: it has finished when release returns)
+    Status release(handle_t handle)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto index = toIndex(handle);
+        if (index == NO_INDEX)
+        {
+            return Status::INVALID;
+        }
+        auto status = disarm(index);
+        auto &entry = m_entries[index];
+
+        if (entry.state == State::RUNNING)
+        {
+            if (std::this_thread::get_id() == m_thread.get_id())
+            {
+                entry.releaseAfterRun = true;
+                return status;
+            }
+            m_callbackDone.wait(lock, [&] { return entry.state != State::RUNNING; });
+        }
+        recycle(index);
+        return status;
+    }
+
+    size_t capacity() const
+    {
+        return m_entries.size();
+    }
+
+private:
+    using index_t = uint32_t;
+
+    static constexpr index_t NO_INDEX = std::numeric_limits<index_t>::max();
+
+    enum class State : uint8_t
+    {
+        FREE,
+        IDLE,    //not armed, the callback has not run since the last arm
+        ARMED,   //in the wheel
+        RUNNING, //callback running (may be armed again, i.e. also in the wheel)
+        EXPIRED  //callback has run
+    };
+
+    struct Entry
+    {
+        Callback callback;
+        uint64_t expiry{0};                  //tick
+        std::chrono::nanoseconds deadline{0}; //since m_start
+        std::chrono::nanoseconds period{0};   //0: one-shot
+        std::chrono::nanoseconds slack{0};
+        uint32_t generation{0};
+        index_t prev{NO_INDEX};
+        index_t next{NO_INDEX};
+        uint16_t bucket{0};
+        State state{State::FREE};
+        bool armed{false}; //in the wheel (independent of RUNNING)
+        bool releaseAfterRun{false};
+    };
+
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1 << SLOT_BITS; //one occupancy bit per slot in an uint64_t
+    static constexpr uint32_t LEVELS = 8;             //2^48 ticks
+    static constexpr uint32_t EXPIRING = LEVELS * SLOTS; //bucket of the timers expiring in the current tick
+    static constexpr uint64_t NO_TICK = std::numeric_limits<uint64_t>::max();
+
+    const std::chrono::nanoseconds m_resolution;
+    const clock_t::time_point m_start;
+
+    std::mutex m_mutex;
+    std::condition_variable m_callbackDone;
+
+    std::vector<Entry> m_entries;
+    index_t m_free{NO_INDEX};
+
+    std::array<index_t, LEVELS * SLOTS + 1> m_heads;
+    std::array<uint64_t, LEVELS> m_occupied; //bit i set: slot i of the level is not empty
+
+    uint64_t m_now{0};              //next tick to be processed
+    uint64_t m_programmed{NO_TICK}; //tick the timerfd expires at
+    bool m_stop{false};
+
+    int m_timerFd{-1};
+    std::thread m_thread;
+
+    static handle_t toHandle(index_t index, uint32_t generation)
+    {
+        return (handle_t(generation) << 32) | index;
+    }
+
+    //NO_INDEX for stale handles (the generation does not match) and free entries
+    index_t toIndex(handle_t handle)
+    {
+        auto index = static_cast<index_t>(handle);
+        if (index >= m_entries.size())
+        {
+            return NO_INDEX;
+        }
+        auto &entry = m_entries[index];
+        return entry.state != State::FREE && entry.generation == static_cast<uint32_t>(handle >> 32) ? index : NO_INDEX;
+    }
+
+    Status disarm(index_t index)
+    {
+        auto &entry = m_entries[index];
+        if (entry.armed)
+        {
+            unlink(index);
+            entry.armed = false;
+            if (entry.state == State::ARMED)
+            {
+                entry.state = State::IDLE;
+                return Status::CANCELLED;
+            }
+        }
+        switch (entry.state)
+        {
+        case State::RUNNING:
+            return Status::RUNNING;
+        case State::EXPIRED:
+            return Status::HAS_RUN;
+        default:
+            return Status::NOT_ARMED;
+        }
+    }
+
+    void recycle(index_t index)
+    {
+        auto &entry = m_entries[index];
+        entry.callback = nullptr;
+        entry.state = State::FREE;
+        entry.armed = false;
+        ++entry.generation;
+        entry.next = m_free;
+        m_free = index;
+    }
+
+    uint64_t toTicksRoundedUp(std::chrono::nanoseconds time)
+    {
+        //never expire early
+        return time.count() <= 0 ? 0 : (time.count() + m_resolution.count() - 1) / m_resolution.count();
+    }
+
+    //the tick in [first, last] with the most trailing zeros, i.e. the common prefix followed by a 1 and zeros
+    static uint64_t coalesce(uint64_t first, uint64_t last)
+    {
+        if (last <= first)
+        {
+            return first;
+        }
+        auto bit = 63 - __builtin_clzll(first ^ last);
+        return (last >> bit) << bit;
+    }
+
+    //inserts the entry according to deadline and slack
+    void schedule(index_t index)
+    {
+        auto &entry = m_entries[index];
+        auto first = toTicksRoundedUp(entry.deadline);
+        auto last = static_cast<uint64_t>(std::max<int64_t>((entry.deadline + entry.slack) / m_resolution, 0));
+        auto expiry = coalesce(first, last);
+        entry.expiry = expiry < m_now ? m_now : expiry;
+        entry.armed = true;
+        insert(index);
+
+        if (m_programmed == NO_TICK || entry.expiry < m_programmed)
+        {
+            program(entry.expiry);
+        }
+    }
+
+    uint64_t currentTick()
+    {
+        return (clock_t::now() - m_start) / m_resolution;
+    }
+
+    void pushFront(uint32_t bucket, index_t index)
+    {
+        auto &entry = m_entries[index];
+        entry.bucket = static_cast<uint16_t>(bucket);
+        entry.prev = NO_INDEX;
+        entry.next = m_heads[bucket];
+        if (entry.next != NO_INDEX)
+        {
+            m_entries[entry.next].prev = index;
+        }
+        m_heads[bucket] = index;
+        if (bucket < EXPIRING)
+        {
+            m_occupied[bucket / SLOTS] |= uint64_t(1) << (bucket % SLOTS);
+        }
+    }
+
+    void unlink(index_t index)
+    {
+        auto &entry = m_entries[index];
+        if (entry.prev != NO_INDEX)
+        {
+            m_entries[entry.prev].next = entry.next;
+        }
+        else
+        {
+            m_heads[entry.bucket] = entry.next;
+        }
+        if (entry.next != NO_INDEX)
+        {
+            m_entries[entry.next].prev = entry.prev;
+        }
+        if (m_heads[entry.bucket] == NO_INDEX && entry.bucket < EXPIRING)
+        {
+            m_occupied[entry.bucket / SLOTS] &= ~(uint64_t(1) << (entry.bucket % SLOTS));
+        }
+        entry.prev = entry.next = NO_INDEX;
+    }
+
+    //the level is determined by the highest bit in which expiry and the current tick differ
+    void insert(index_t index)
+    {
+        auto expiry = m_entries[index].expiry;
+        auto difference = expiry ^ m_now;
+        uint32_t level = difference == 0 ? 0 : (63 - __builtin_clzll(difference)) / SLOT_BITS;
+        if (level >= LEVELS)
+        {
+            level = LEVELS - 1; //more than 2^48 ticks in the future, expires early (practically unreachable)
+        }
+        auto slot = (expiry >> (level * SLOT_BITS)) & (SLOTS - 1);
+        pushFront(level * SLOTS + slot, index);
+    }
+
+    //the next tick at which a timer expires or has to be cascaded to a lower level
+    uint64_t nextEventTick()
+    {
+        //all occupied slots of a level are at or after the current slot of the level
+        //and every slot of a level is processed before the slots of the next level
+        for (uint32_t level = 0; level < LEVELS; ++level)
+        {
+            auto shift = level * SLOT_BITS;
+            auto current = (m_now >> shift) & (SLOTS - 1);
+            auto occupied = m_occupied[level] & (~uint64_t(0) << current);
+            if (occupied != 0)
+            {
+                auto window = shift + SLOT_BITS;
+                auto base = window < 64 ? (m_now >> window) << window : 0;
+                return base | (uint64_t(__builtin_ctzll(occupied)) << shift);
+            }
+        }
+        return NO_TICK;
+    }
+
+    void cascade(uint32_t level, uint64_t tick)
+    {
+        auto bucket = level * SLOTS + ((tick >> (level * SLOT_BITS)) & (SLOTS - 1));
+        auto index = m_heads[bucket];
+        m_heads[bucket] = NO_INDEX;
+        m_occupied[level] &= ~(uint64_t(1) << (bucket % SLOTS));
+        while (index != NO_INDEX)
+        {
+            auto next = m_entries[index].next;
+            insert(index); //to a lower level (or level 0 slot of this tick)
+            index = next;
+        }
+    }
+
+    //processes tick m_now, the lock is released while callbacks run
+    void processTick(std::unique_lock<std::mutex> &lock)
+    {
+        auto tick = m_now;
+        for (uint32_t level = LEVELS - 1; level > 0; --level)
+        {
+            if ((tick & ((uint64_t(1) << (level * SLOT_BITS)) - 1)) == 0)
+            {
+                cascade(level, tick);
+            }
+        }
+
+        //move the expiring timers to a separate bucket, so timers armed by the callbacks are not processed
+        //during this tick and the expiring ones can still be disarmed
+        auto bucket = tick & (SLOTS - 1);
+        auto index = m_heads[bucket];
+        m_heads[bucket] = NO_INDEX;
+        m_occupied[0] &= ~(uint64_t(1) << bucket);
+        m_now = tick + 1;
+        while (index != NO_INDEX)
+        {
+            auto next = m_entries[index].next;
+            pushFront(EXPIRING, index);
+            index = next;
+        }
+
+        while ((index = m_heads[EXPIRING]) != NO_INDEX)
+        {
+            unlink(index);
+            auto &entry = m_entries[index];
+            entry.state = State::RUNNING;
+            entry.armed = false;
+
+            //periodic timers are armed again before the callback, so it can disarm (or rearm) them
+            if (entry.period.count() > 0)
+            {
+                entry.deadline += entry.period;
+                auto now = clock_t::now() - m_start;
+                if (entry.deadline <= now)
+                {
+                    entry.deadline += entry.period * ((now - entry.deadline) / entry.period + 1);
+                }
+                schedule(index);
+            }
+
+            lock.unlock();
+            entry.callback(); //the entry cannot be recycled while running (release waits)
+            lock.lock();
+
+            //the callback may have armed the timer again
+            entry.state = entry.armed ? State::ARMED : State::EXPIRED;
+            if (entry.releaseAfterRun)
+            {
+                if (entry.armed)
+                {
+                    unlink(index);
+                }
+                recycle(index);
+            }
+            m_callbackDone.notify_all();
+        }
+    }
+
+    void program(uint64_t tick)
+    {
+        itimerspec spec{};
+        if (tick != NO_TICK)
+        {
+            auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(m_start.time_since_epoch()) +
+                        m_resolution * static_cast<int64_t>(tick);
+            //an absolute time of 0 would disarm the timerfd
+            auto ns = time.count() > 0 ? time.count() : 1;
+            spec.it_value.tv_sec = ns / 1000000000;
+            spec.it_value.tv_nsec = ns % 1000000000;
+        }
+        timerfd_settime(m_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+        m_programmed = tick;
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop)
+        {
+            auto target = currentTick();
+            uint64_t tick;
+            while ((tick = nextEventTick()) <= target)
+            {
+                m_now = tick;
+                processTick(lock);
+            }
+            if (m_now <= target)
+            {
+                m_now = target + 1; //no work in between
+            }
+
+            //the destructor may have stopped us while a callback ran without the lock,
+            //reprogramming would overwrite its wake up and block forever
+            if (m_stop)
+            {
+                break;
+            }
+
+            program(nextEventTick());
+            lock.unlock();
+
+            //blocks until the programmed tick, reprogramming by arm takes effect immediately
+            uint64_t expirations;
+            auto result = read(m_timerFd, &expirations, sizeof(expirations));
+            (void)result; //EINTR or a disarmed timer, we just recompute
+
+            lock.lock();
+        }
+    }
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "io_uring.hpp"
+#include "wait_any.hpp"
+
+#ifndef CP_URING_FALLBACK_SLICE_US
+#define CP_URING_FALLBACK_SLICE_US 1000 //without IORING_OP_FUTEX_WAIT: the source is checked again after this time
+#endif
+
+namespace uring
+{
+
+//acquires a Semaphore, AutoResetEvent or Lock through a ring, i.e. a thread that waits for I/O completions
+//in io_uring_enter is also woken by post/signal/unlock (instead of blocking in two places)
+//
+//arm acquires the source or submits (with the next submit of the ring) a futex wait on its word,
+//the completions with userData are passed to complete, which acquires the source or waits again
+//on kernels without IORING_OP_FUTEX_WAIT (before 6.7) a timeout of CP_URING_FALLBACK_SLICE_US is submitted instead,
+//the source is then noticed with that delay, without io_uring wait for it with the primitive itself
+//
+//the ring and the FutexWait belong to one thread, a wait set can be waited for with a ws::WaitSet<EpollSignaller>
+//(IORING_OP_POLL_ADD on its fd)
+class FutexWait
+{
+public:
+    FutexWait(Ring &ring, Waitable source, uint64_t userData)
+        : m_ring(&ring), m_source(source), m_userData(userData), m_futex(futexSupported())
+    {
+    }
+
+    ~FutexWait()
+    {
+        cancel();
+    }
+
+    FutexWait(const FutexWait &) = delete;
+    FutexWait(FutexWait &&) = delete;
+
+    uint64_t userData() const
+    {
+        return m_userData;
+    }
+
+    //true if the source was acquired (arm again for the next one), otherwise a wait is pending
+    bool arm()
+    {
+        if (m_state != State::IDLE)
+        {
+            return false;
+        }
+
+        auto &operations = *m_source.m_operations;
+        if (operations.tryAcquire(m_source.m_primitive))
+        {
+            return true;
+        }
+        if (operations.enter(m_source.m_primitive) || operations.tryAcquireEntered(m_source.m_primitive))
+        {
+            operations.leave(m_source.m_primitive, true);
+            return true;
+        }
+
+        m_state = State::PENDING;
+        submitWait();
+        return false;
+    }
+
+    //for a completion with our user data: true if the source was acquired (arm again for the next one),
+    //otherwise the wait is submitted again (completions of a cancelled wait are ignored)
+    bool complete(const io_uring_cqe &)
+    {
+        if (m_state != State::PENDING)
+        {
+            return false;
+        }
+
+        //woken, -EAGAIN (the word changed before the wait) or the fallback timeout, try again in any case
+        auto &operations = *m_source.m_operations;
+        if (operations.tryAcquireEntered(m_source.m_primitive))
+        {
+            operations.leave(m_source.m_primitive, true);
+            m_state = State::IDLE;
+            return true;
+        }
+        submitWait();
+        return false;
+    }
+
+    //cancels a pending wait and submits the cancellation, the FutexWait cannot be armed again
+    //(a wake up it may have taken is passed on to another waiter)
+    void cancel()
+    {
+        if (m_state == State::PENDING)
+        {
+            prepareCancel(nextSqe(), m_userData, m_userData);
+            m_ring->submit();
+            m_source.m_operations->leave(m_source.m_primitive, false);
+        }
+        m_state = State::CANCELLED;
+    }
+
+private:
+    enum class State
+    {
+        IDLE,
+        PENDING,
+        CANCELLED
+    };
+
+    Ring *m_ring;
+    Waitable m_source;
+    uint64_t m_userData;
+    bool m_futex;
+    State m_state{State::IDLE};
+    __kernel_timespec m_slice{0, CP_URING_FALLBACK_SLICE_US * 1000};
+
+    void submitWait()
+    {
+        auto sqe = nextSqe();
+        if (m_futex)
+        {
+            auto &operations = *m_source.m_operations;
+            prepareFutexWait(sqe, operations.word(m_source.m_primitive), operations.expected, m_userData);
+        }
+        else
+        {
+            prepareTimeout(sqe, &m_slice, m_userData);
+        }
+    }
+
+    io_uring_sqe *nextSqe()
+    {
+        auto sqe = m_ring->sqe();
+        while (!sqe)
+        {
+            m_ring->submit(); //full, make room
+            sqe = m_ring->sqe();
+        }
+        return sqe;
+    }
+};
+
+} // namespace uring
@@ -0,0 +1,294 @@
+#pragma once
+
+#include "futex.hpp"
+#include "semaphore.hpp"
+#include "autoreset_event.hpp"
+#include "lock.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+
+#ifndef CP_WAIT_ANY_FALLBACK_SLICE_US
+#define CP_WAIT_ANY_FALLBACK_SLICE_US 1000 //without futex_waitv: time slept on one source before the next is checked
+#endif
+
+#ifndef CP_WAIT_ANY_FORCE_FALLBACK
+#define CP_WAIT_ANY_FORCE_FALLBACK 0 //1: never use futex_waitv, e.g. to test the fallback on a kernel that has it
+#endif
+
+//how waitAny acquires and waits for a primitive (specialized for each one, a friend of the primitive)
+//
+//acquiring means what wait (or lock) does: a semaphore is decremented, an event signal is consumed, a lock is locked
+//a waiter registers itself (as its own wait does, i.e. the wakers issue futex wakes) and sleeps on the futex word,
+//a waiter that leaves without acquiring it passes on a wake up it may have taken from another waiter
+template <typename T>
+struct WaitAnySource;
+
+namespace uring
+{
+class FutexWait;
+}
+
+template <>
+struct WaitAnySource<Semaphore>
+{
+    static constexpr int32_t EXPECTED = 0; //sleep while the value is 0
+
+    static bool tryAcquire(Semaphore &semaphore)
+    {
+        return semaphore.tryWait();
+    }
+
+    //true if acquired while registering
+    static bool enter(Semaphore &semaphore)
+    {
+        semaphore.waitCount.fetch_add(1, std::memory_order_acq_rel);
+        return false;
+    }
+
+    static bool tryAcquireEntered(Semaphore &semaphore)
+    {
+        return semaphore.tryWait();
+    }
+
+    static int32_t *word(Semaphore &semaphore)
+    {
+        return semaphore.futexWord();
+    }
+
+    static void leave(Semaphore &semaphore, bool acquired)
+    {
+        semaphore.waitCount.fetch_sub(1, std::memory_order_acq_rel);
+        if (!acquired && semaphore.value.load(std::memory_order_acquire) > 0 &&
+            semaphore.waitCount.load(std::memory_order_acquire) > 0)
+        {
+            semaphore.wake(1); //the post may have woken us instead of another waiter
+        }
+    }
+};
+
+template <>
+struct WaitAnySource<Lock>
+{
+    static constexpr int32_t EXPECTED = Lock::CONTESTED;
+
+    static bool tryAcquire(Lock &lock)
+    {
+        return lock.compareExchangeState(Lock::UNLOCKED, Lock::LOCKED) == Lock::UNLOCKED;
+    }
+
+    static bool enter(Lock &)
+    {
+        return false;
+    }
+
+    //as the slow path of lock: marked contested, i.e. unlock wakes a sleeper
+    static bool tryAcquireEntered(Lock &lock)
+    {
+        return lock.exchangeState(Lock::CONTESTED) == Lock::UNLOCKED;
+    }
+
+    static int32_t *word(Lock &lock)
+    {
+        return lock.futexWord();
+    }
+
+    static void leave(Lock &lock, bool acquired)
+    {
+        if (!acquired && lock.state.load(std::memory_order_acquire) == Lock::UNLOCKED)
+        {
+            lock.wakeOne(); //the unlock may have woken us instead of another waiter
+        }
+    }
+};
+
+template <>
+struct WaitAnySource<AutoResetEvent>
+{
+    using SemaphoreSource = WaitAnySource<Semaphore>;
+    static constexpr int32_t EXPECTED = SemaphoreSource::EXPECTED;
+
+    static bool tryAcquire(AutoResetEvent &event)
+    {
+        int64_t signalled = 1;
+        return event.m_count.compare_exchange_strong(signalled, 0, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    //counted as a waiter of the event (as in wait), a signal posts the semaphore for us
+    //true if it was signalled (then we are not counted)
+    static bool enter(AutoResetEvent &event)
+    {
+        SemaphoreSource::enter(event.m_semaphore);
+        return event.m_count.fetch_sub(1, std::memory_order_acquire) >= 1;
+    }
+
+    static bool tryAcquireEntered(AutoResetEvent &event)
+    {
+        return event.m_semaphore.tryWait();
+    }
+
+    static int32_t *word(AutoResetEvent &event)
+    {
+        return event.m_semaphore.futexWord();
+    }
+
+    //as the timeout of waitUntil: either we are still counted and remove ourselves,
+    //or the signal was already posted for us, then it is consumed and given back
+    static void leave(AutoResetEvent &event, bool acquired)
+    {
+        if (acquired)
+        {
+            SemaphoreSource::leave(event.m_semaphore, true);
+            return;
+        }
+
+        auto count = event.m_count.load(std::memory_order_relaxed);
+        while (count < 0)
+        {
+            if (event.m_count.compare_exchange_weak(count, count + 1, std::memory_order_relaxed, std::memory_order_relaxed))
+            {
+                SemaphoreSource::leave(event.m_semaphore, false);
+                return;
+            }
+        }
+        SemaphoreSource::leave(event.m_semaphore, true); //the post is for us, nothing to pass on
+        event.m_semaphore.wait();                        //returns immediately (or very soon)
+        event.signal();
+    }
+};
+
+//a primitive waitAny can wait for, implicitly constructible from a pointer to a Semaphore, AutoResetEvent or Lock
+class Waitable
+{
+public:
+    template <typename T, typename = decltype(WaitAnySource<T>::EXPECTED)>
+    Waitable(T *primitive) : m_primitive(primitive), m_operations(&operations<T>)
+    {
+    }
+
+private:
+    friend std::optional<size_t> waitAnyUntil(const Waitable *, size_t, std::chrono::steady_clock::time_point);
+    friend class uring::FutexWait;
+
+    struct Operations
+    {
+        bool (*tryAcquire)(void *);
+        bool (*enter)(void *);
+        bool (*tryAcquireEntered)(void *);
+        int32_t *(*word)(void *);
+        void (*leave)(void *, bool);
+        int32_t expected;
+    };
+
+    void *m_primitive;
+    const Operations *m_operations;
+
+    template <typename T>
+    static constexpr Operations operations{
+        [](void *p) { return WaitAnySource<T>::tryAcquire(*static_cast<T *>(p)); },
+        [](void *p) { return WaitAnySource<T>::enter(*static_cast<T *>(p)); },
+        [](void *p) { return WaitAnySource<T>::tryAcquireEntered(*static_cast<T *>(p)); },
+        [](void *p) { return WaitAnySource<T>::word(*static_cast<T *>(p)); },
+        [](void *p, bool acquired) { WaitAnySource<T>::leave(*static_cast<T *>(p), acquired); },
+        WaitAnySource<T>::EXPECTED};
+};
+
+//acquires one of the sources (the first available one in their order) and returns its index,
+//nullopt if none was available until the deadline (or there are more than futex::WAITV_MAX sources)
+//
+//blocks with futex_waitv on the futex words of all sources at once, on kernels without it (before 5.16)
+//it sleeps on one source at a time for CP_WAIT_ANY_FALLBACK_SLICE_US, i.e. the others are noticed with that delay
+inline std::optional<size_t> waitAnyUntil(const Waitable *sources, size_t count,
+                                          std::chrono::steady_clock::time_point deadline)
+{
+    if (count == 0 || count > futex::WAITV_MAX)
+    {
+        return std::nullopt;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (sources[i].m_operations->tryAcquire(sources[i].m_primitive))
+        {
+            return i;
+        }
+    }
+
+    //register at all of them, a source that is acquired while registering ends the wait
+    //(every source that was entered is left exactly once)
+    std::optional<size_t> result;
+    size_t entered = 0;
+    while (entered < count && !result)
+    {
+        if (sources[entered].m_operations->enter(sources[entered].m_primitive))
+        {
+            result = entered;
+        }
+        ++entered;
+    }
+
+    futex::WaitvEntry entries[futex::WAITV_MAX];
+    for (size_t i = 0; i < entered; ++i)
+    {
+        auto &operations = *sources[i].m_operations;
+        entries[i] = futex::waitvEntry(operations.word(sources[i].m_primitive), operations.expected);
+    }
+
+    constexpr auto NO_DEADLINE = std::chrono::steady_clock::time_point::max();
+    bool waitv = !CP_WAIT_ANY_FORCE_FALLBACK && futex::waitvSupported();
+    size_t slice = 0;
+    while (!result)
+    {
+        for (size_t i = 0; i < entered; ++i)
+        {
+            if (sources[i].m_operations->tryAcquireEntered(sources[i].m_primitive))
+            {
+                result = i;
+                break;
+            }
+        }
+        if (result || (deadline != NO_DEADLINE && std::chrono::steady_clock::now() >= deadline))
+        {
+            break;
+        }
+
+        if (waitv)
+        {
+            futex::waitv(entries, static_cast<uint32_t>(entered), deadline);
+        }
+        else
+        {
+            auto sliceEnd = std::chrono::steady_clock::now() + std::chrono::microseconds(CP_WAIT_ANY_FALLBACK_SLICE_US);
+            auto &entry = entries[slice];
+            futex::waitUntil(reinterpret_cast<int32_t *>(entry.address), static_cast<int32_t>(entry.value),
+                             std::min(sliceEnd, deadline));
+            slice = (slice + 1) % entered;
+        }
+    }
+
+    for (size_t i = 0; i < entered; ++i)
+    {
+        sources[i].m_operations->leave(sources[i].m_primitive, result && *result == i);
+    }
+    return result;
+}
+
+//waitAny({&semaphore, &event, &lock}) returns the index of the acquired one (at most futex::WAITV_MAX sources)
+inline size_t waitAny(std::initializer_list<Waitable> sources)
+{
+    return waitAnyUntil(sources.begin(), sources.size(), std::chrono::steady_clock::time_point::max()).value_or(SIZE_MAX);
+}
+
+inline std::optional<size_t> waitAnyUntil(std::initializer_list<Waitable> sources,
+                                          std::chrono::steady_clock::time_point deadline)
+{
+    return waitAnyUntil(sources.begin(), sources.size(), deadline);
+}
+
+inline std::optional<size_t> waitAnyFor(std::initializer_list<Waitable> sources, std::chrono::nanoseconds timeout)
+{
+    return waitAnyUntil(sources, std::chrono::steady_clock::now() + timeout);
+}
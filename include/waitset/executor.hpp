@@ -0,0 +1,83 @@
+#pragma once
+
+#include "semaphore.hpp"
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//runs tasks on other threads, e.g. the callbacks of a WaitSet
+class Executor
+{
+public:
+    using Task = std::function<void(void)>;
+
+    virtual ~Executor() = default;
+    virtual void post(Task task) = 0;
+};
+
+//fixed number of threads taking tasks from one queue in FIFO order
+//destruction runs the tasks that are already queued and joins the threads
+class ThreadPool : public Executor
+{
+public:
+    ThreadPool(size_t numThreads)
+    {
+        for (size_t i = 0; i < numThreads; ++i)
+        {
+            m_threads.emplace_back(&ThreadPool::run, this);
+        }
+    }
+
+    ~ThreadPool()
+    {
+        //one empty task per thread, queued after all others
+        for (size_t i = 0; i < m_threads.size(); ++i)
+        {
+            post(Task());
+        }
+        for (auto &thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool(ThreadPool &&) = delete;
+
+    void post(Task task) override
+    {
+        {
+            std::lock_guard g(m_queueMutex);
+            m_queue.push_back(std::move(task));
+        }
+        m_numTasks.post();
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex m_queueMutex;
+    std::deque<Task> m_queue;
+    Semaphore m_numTasks; //number of queued tasks
+
+    void run()
+    {
+        while (true)
+        {
+            m_numTasks.wait();
+            Task task;
+            {
+                std::lock_guard g(m_queueMutex);
+                task = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            if (!task)
+            {
+                return;
+            }
+            task();
+        }
+    }
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+//atomic bitmap of ready ids, set concurrently by notifiers and collected by the (single) waiter
+//the waiter takes a whole word at a time (exchange with 0) and visits its bits with ctz,
+//i.e. collecting costs one load per 64 ids plus the number of ready ids
+class ReadySet
+{
+public:
+    static constexpr size_t BITS = 64;
+
+    ReadySet(size_t capacity) : m_numWords((capacity + BITS - 1) / BITS)
+    {
+        //the number of words is rounded up to blocks of 4 for the AVX2 scan
+        m_allocatedWords = (m_numWords + 3) / 4 * 4;
+        auto memory = operator new[](m_allocatedWords * sizeof(Word), std::align_val_t(32));
+        m_words.reset(static_cast<Word *>(memory));
+        for (size_t i = 0; i < m_allocatedWords; ++i)
+        {
+            new (&m_words[i]) Word(0);
+        }
+    }
+
+    ReadySet(const ReadySet &) = delete;
+    ReadySet(ReadySet &&) = delete;
+
+    //returns true if the id was not set before
+    //release: whatever the notifier did before is visible to the waiter collecting the id
+    //(seq_cst for the waiter awake check of the WaitSet, same cost as release on x86)
+    bool set(size_t id)
+    {
+        auto mask = uint64_t(1) << (id % BITS);
+        return (m_words[id / BITS].fetch_or(mask, std::memory_order_seq_cst) & mask) == 0;
+    }
+
+    void reset(size_t id)
+    {
+        m_words[id / BITS].fetch_and(~(uint64_t(1) << (id % BITS)), std::memory_order_relaxed);
+    }
+
+    bool isSet(size_t id) const
+    {
+        return (m_words[id / BITS].load(std::memory_order_relaxed) >> (id % BITS)) & 1;
+    }
+
+    //removes all set ids and calls f(id) for each of them (in ascending order), returns the number of ids
+    template <typename F>
+    size_t collect(F f)
+    {
+        return collect(f, SIZE_MAX);
+    }
+
+    //as above but removes at most maxCount ids, the remaining ones stay set
+    template <typename F>
+    size_t collect(F f, size_t maxCount)
+    {
+        size_t count = 0;
+        size_t i = 0;
+#if defined(__AVX2__)
+        //skip blocks of 4 zero words with one (non-atomic) vector load, only the non-zero words are exchanged
+        //a word that becomes non-zero concurrently is either seen here or has signalled the waiter again
+        for (; i < m_allocatedWords && count < maxCount; i += 4)
+        {
+            auto block = _mm256_load_si256(reinterpret_cast<const __m256i *>(&m_words[i]));
+            if (!_mm256_testz_si256(block, block))
+            {
+                for (size_t j = i; j < i + 4; ++j)
+                {
+                    count += collectWord(j, f, maxCount - count);
+                }
+            }
+        }
+#endif
+        for (; i < m_numWords && count < maxCount; ++i)
+        {
+            count += collectWord(i, f, maxCount - count);
+        }
+        return count;
+    }
+
+    //as collect, but removes the ids one at a time (fetch_and of a single bit),
+    //i.e. several threads can claim concurrently and each id is claimed by exactly one of them
+    template <typename F>
+    size_t claim(F f, size_t maxCount)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < m_numWords && count < maxCount; ++i)
+        {
+            auto bits = m_words[i].load(std::memory_order_relaxed);
+            while (bits != 0 && count < maxCount)
+            {
+                auto bit = __builtin_ctzll(bits);
+                auto mask = uint64_t(1) << bit;
+                //acquire: pairs with the release of set
+                bits = m_words[i].fetch_and(~mask, std::memory_order_acquire);
+                if (bits & mask)
+                {
+                    f(i * BITS + bit);
+                    ++count;
+                }
+                bits &= ~mask;
+            }
+        }
+        return count;
+    }
+
+    //seq_cst: pairs with set for the waiter awake check of the WaitSet
+    bool any() const
+    {
+        for (size_t i = 0; i < m_numWords; ++i)
+        {
+            if (m_words[i].load(std::memory_order_seq_cst) != 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    using Word = std::atomic<uint64_t>;
+    static_assert(sizeof(Word) == sizeof(uint64_t), "atomic words must be plain 64 bit words");
+
+    size_t m_numWords;
+    size_t m_allocatedWords;
+
+    //32 byte aligned for aligned vector loads (atomic words are trivially destructible)
+    struct Deleter
+    {
+        void operator()(Word *words)
+        {
+            operator delete[](words, std::align_val_t(32));
+        }
+    };
+    std::unique_ptr<Word[], Deleter> m_words;
+
+    template <typename F>
+    size_t collectWord(size_t index, F &f, size_t maxCount)
+    {
+        auto &word = m_words[index];
+        if (maxCount == 0 || word.load(std::memory_order_relaxed) == 0)
+        {
+            return 0;
+        }
+
+        //acquire: pairs with the release of set
+        auto bits = word.exchange(0, std::memory_order_acquire);
+        size_t count = 0;
+        while (bits != 0 && count < maxCount)
+        {
+            auto bit = __builtin_ctzll(bits);
+            bits &= bits - 1;
+            f(index * BITS + bit);
+            ++count;
+        }
+        if (bits != 0)
+        {
+            word.fetch_or(bits, std::memory_order_relaxed); //not visited, put them back
+        }
+        return count;
+    }
+};
@@ -2,46 +2,72 @@
 
 #include "waitset_types.hpp"
 
+#include <atomic>
+
 //internal to waitset, waitset must outlive the node (nodes will be owned and destroyed by waitset)
 class WaitNode
 {
     friend class WaitToken;
     friend class WaitSet;
 
-    using Deleter = std::function<void(id_t &)>;
-
 public:
-    WaitNode(WaitSet *waitSet, const Condition &condition) : m_waitSet(waitSet), m_condition(condition)
+    WaitNode(WaitSet *waitSet, const Condition &condition, TriggerMode mode) : m_waitSet(waitSet), m_condition(condition), m_mode(mode)
     {
     }
 
-    WaitNode(WaitSet *waitSet, const Condition &condition, const Callback &callback) : m_waitSet(waitSet), m_condition(condition), m_callback(callback)
+    WaitNode(WaitSet *waitSet, const Condition &condition, const Callback &callback, TriggerMode mode) : m_waitSet(waitSet), m_condition(condition), m_callback(callback), m_mode(mode)
     {
     }
 
     bool evalMonotonic()
     {
-        if (m_result)
+        if (m_result.load(std::memory_order_acquire))
         {
             return true; //was true and not reset yet
         }
 
         if (m_condition())
         {
-            m_result = true; //monotonic, can be set to true but not to false (can be set to false by waitset)
+            //monotonic, can be set to true but not to false (can be set to false by waitset)
+            m_result.store(true, std::memory_order_release);
             return true;
         }
         return false;
     }
 
+    //true if the waiter must be notified, a one-shot node is disarmed by the first notification that finds
+    //the condition true (concurrent notifications do not fire it twice)
+    bool fire()
+    {
+        if (m_mode != TriggerMode::ONE_SHOT)
+        {
+            return evalMonotonic();
+        }
+        if (!m_armed.load(std::memory_order_acquire) || !m_condition())
+        {
+            return false;
+        }
+        if (!m_armed.exchange(false, std::memory_order_acq_rel))
+        {
+            return false; //fired by someone else
+        }
+        m_result.store(true, std::memory_order_release);
+        return true;
+    }
+
     bool eval()
     {
         return m_condition();
     }
 
+    TriggerMode mode() const
+    {
+        return m_mode;
+    }
+
     bool getResult() const
     {
-        return m_result;
+        return m_result.load(std::memory_order_acquire);
     }
 
     void exec()
@@ -50,30 +76,63 @@ public:
             m_callback();
     }
 
-    void setCallback(const Callback &callback)
+    //strand of the callback on an executor, the callback does not run concurrently with itself
+    //returns true if the strand was idle and must be posted to the executor
+    bool schedule()
     {
-        m_callback = callback;
+        auto state = m_strand.load(std::memory_order_relaxed);
+        while (true)
+        {
+            if (state == RESCHEDULED)
+            {
+                return false;
+            }
+            //idle: queue it, queued or running: make sure it runs (once) again after the current run
+            auto next = state == IDLE ? SCHEDULED : RESCHEDULED;
+            if (m_strand.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                return next == SCHEDULED;
+            }
+        }
     }
 
-    //refactor this somewhat, e.g. construction time
-    void setDeleter(const Deleter &deleter)
+    //called by the strand after a run, true if it must run again (otherwise it is idle now)
+    bool reschedule()
     {
-        m_deleter = deleter;
+        auto state = m_strand.load(std::memory_order_acquire);
+        while (true)
+        {
+            auto next = state == RESCHEDULED ? SCHEDULED : IDLE;
+            if (m_strand.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                return next == SCHEDULED;
+            }
+        }
     }
 
-    void tryDelete()
+    void setCallback(const Callback &callback)
     {
-        if (m_deleter)
-        {
-            m_deleter(m_id);
-        }
+        m_callback = callback;
     }
 
     void notify();
 
+    //drops a token reference, the wait set removes the node with the last reference (do not use it afterwards)
+    void release();
+
+    //a fired one-shot node can fire again (immediately if the condition is true)
+    void rearm()
+    {
+        if (m_mode == TriggerMode::ONE_SHOT)
+        {
+            m_armed.store(true, std::memory_order_release);
+            notify();
+        }
+    }
+
     void reset()
     {
-        m_result = false;
+        m_result.store(false, std::memory_order_relaxed);
     }
 
     id_t id() const
@@ -88,31 +147,34 @@ public:
 
     uint64_t numReferences() const
     {
-        return m_refCount;
+        return m_refCount.load(std::memory_order_acquire);
     }
 
 private:
-    uint64_t m_refCount{0};
+    std::atomic<uint64_t> m_refCount{0}; //tokens and waiters running the callback (see WaitSet::claim)
     id_t m_id;
     WaitSet *m_waitSet;
     Condition m_condition;
-    bool m_result{false}; //todo: may need to use an atomic
+    std::atomic<bool> m_result{false}; //set by notifiers, reset by the waiter
     Callback m_callback;
+    TriggerMode m_mode;
+    std::atomic<bool> m_armed{true}; //one-shot only, reset when it fires
 
-    //needed since we want to call a delete method of WaitSet in here but WaitSet depends on WaitNode itself
-    //(and want to avoid virtual interfaces)
-    //function must not depend on the node itself, since it may trigger its deletion
-    Deleter m_deleter;
+    enum StrandState : uint32_t
+    {
+        IDLE,
+        SCHEDULED,  //queued or running
+        RESCHEDULED //running and must run again
+    };
+    std::atomic<uint32_t> m_strand{IDLE};
 
     uint64_t incrementRefCount()
     {
-        ++m_refCount;
-        return m_refCount;
+        return m_refCount.fetch_add(1, std::memory_order_relaxed) + 1;
     }
 
     uint64_t decrementRefCount()
     {
-        --m_refCount;
-        return m_refCount;
+        return m_refCount.fetch_sub(1, std::memory_order_acq_rel) - 1;
     }
 };
\ No newline at end of file
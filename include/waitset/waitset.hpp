@@ -2,11 +2,16 @@
 
 #include "autoreset_event.hpp"
 #include "container.hpp"
+#include "ready_set.hpp"
+#include "executor.hpp"
+#include "instrumentation/probes.hpp"
 
+#include <chrono>
 #include <vector>
 #include <functional>
 #include <optional>
 #include <mutex>
+#include <type_traits>
 
 #include "waitset_types.hpp"
 #include "waittoken.hpp"
@@ -15,14 +20,22 @@
 class WaitSet
 {
 public:
-    WaitSet(id_t capacity) : m_capacity(capacity), m_nodes(capacity)
+    WaitSet(id_t capacity) : m_capacity(capacity), m_nodes(capacity), m_ready(capacity), m_delivered(capacity)
     {
     }
 
-    std::optional<WaitToken> add(const Condition &condition)
+    //dispatch mode: the callbacks are not run by the waiting thread but posted to the executor,
+    //the callbacks of one node are serialized (a strand) while different nodes run in parallel
+    //wait returns when the callbacks are dispatched, the executor must run all tasks before the wait set is destroyed
+    WaitSet(id_t capacity, Executor &executor) : WaitSet(capacity)
+    {
+        m_executor = &executor;
+    }
+
+    std::optional<WaitToken> add(const Condition &condition, TriggerMode mode = TriggerMode::EDGE)
     {
         std::lock_guard g(m_nodesMutex);
-        auto maybeId = m_nodes.emplace(this, condition);
+        auto maybeId = m_nodes.emplace(this, condition, mode);
 
         if (!maybeId.has_value())
         {
@@ -36,16 +49,14 @@ public:
         //we create a WaitToken and hence increment the refCount
         node.incrementRefCount();
 
-        //todo: we need to be very careful here that this function call does not rely on anything it deletes...
-        node.setDeleter([=](id_t id) { this->remove(id); });
-
         return WaitToken(node);
     }
 
-    std::optional<WaitToken> add(const Condition &condition, const Callback &callback)
+    std::optional<WaitToken> add(const Condition &condition, const Callback &callback,
+                                 TriggerMode mode = TriggerMode::EDGE)
     {
         std::lock_guard g(m_nodesMutex);
-        auto maybeId = m_nodes.emplace(this, condition, callback);
+        auto maybeId = m_nodes.emplace(this, condition, callback, mode);
 
         if (!maybeId.has_value())
         {
@@ -58,101 +69,202 @@ public:
         //we create a WaitToken and hence increment the refCount
         node.incrementRefCount();
 
-        //todo: we need to be very careful here that this function call does not rely on anything it deletes...
-        node.setDeleter([=](id_t id) { this->remove(id); });
-
         return WaitToken(node);
     }
 
-    //todo: we could also add a timed wait but in theory this can be done with a condition that is set to true by a timer
-
     //we can only have one waiter for proper operation (concurrent condition result reset would cause problems!)
+    //use claim for several waiting threads
     WakeUpSet wait()
     {
         WakeUpSet wakeUpSet;
+        wait([&](id_t id) { wakeUpSet.push_back(id); });
+        return wakeUpSet;
+    }
 
-        do
+    //does not allocate: writes at most capacity ids into the buffer and returns their number (> 0),
+    //ready ids that do not fit are returned by the next wait (which does not block)
+    size_t wait(id_t *ids, size_t capacity)
+    {
+        if (capacity == 0)
         {
-            m_autoResetEvent.wait();
+            return 0;
+        }
+        size_t count = 0;
+        waitAndCollect([&](id_t id) { ids[count++] = id; }, capacity);
+        return count;
+    }
 
-            // find the nodes whose conditions were true
-            // (we have to iterate, we have no other information when we just use a single semaphore)
-            // alternatively notify could prepare a wakeup set ... but we need to eliminate duplicates and so on,
-            // losing any advantage for reasonably small numbers of conditions
+    //does not allocate: calls f(id) for each ready id after its callback, returns the number of ids (> 0)
+    //f is called with the nodes locked, i.e. it must not add conditions or destroy tokens
+    template <typename F, typename = std::enable_if_t<std::is_invocable_v<F &, id_t>>>
+    size_t wait(F f)
+    {
+        return waitAndCollect(f, SIZE_MAX);
+    }
 
-            std::lock_guard g(m_nodesMutex);
-            auto n = m_nodes.size();
-            for (size_t id = 0; id < n; ++id)
+    //multi consumer: any number of threads can claim concurrently (but must not be mixed with wait),
+    //each ready id is claimed by exactly one of them (by atomically clearing its ready bit)
+    //
+    //blocks until at least one id is claimed, runs the callbacks of the claimed ids and calls f(id) for each,
+    //returns the number of claimed ids (at most maxCount)
+    //idle threads park on the event and are woken one at a time, a thread that leaves ready ids behind wakes the next one
+    //the nodes are not locked while the callbacks run, i.e. callbacks of different ids run in parallel
+    //(the callback of an id that becomes ready again while it runs can run concurrently on another thread)
+    template <typename F, typename = std::enable_if_t<std::is_invocable_v<F &, id_t>>>
+    size_t claim(F f, size_t maxCount = 1)
+    {
+        instrumentation::onWaitBegin(this);
+        size_t count = 0;
+
+        while (count == 0)
+        {
+            recheckDelivered();
+            m_autoResetEvent.wait();
+
+            while (count < maxCount)
             {
-                WaitNode &node = m_nodes[id];
-                if (node.getResult())
+                WaitNode *node = claimNode();
+                if (!node)
                 {
-                    node.exec();
-                    wakeUpSet.push_back(id);
-                    node.reset(); //set condition back to false
-                    // someone may be setting them to true for a second time right now, but we have not fully woken up
-                    // so that is ok (we can see that the condition was true, but not how many times it changed)
-                    // if a new node becomes true there is another notify were it is set to true OR
-                    // we registered it in already in this wakeup
+                    break;
                 }
+                if (count == 0 && m_ready.any())
+                {
+                    m_autoResetEvent.signal(); //let another waiter take the rest
+                }
+                auto id = node->id();
+                execute(*node);
+                f(id);
+                release(*node);
+                ++count;
             }
-        } while (wakeUpSet.empty()); //do not wake up when no conditions are true
+        }
+
+        instrumentation::onWaitEnd(this);
+        return count;
+    }
 
+    //claims at most capacity ids and writes them into the buffer, does not allocate
+    size_t claim(id_t *ids, size_t capacity)
+    {
+        if (capacity == 0)
+        {
+            return 0;
+        }
+        size_t count = 0;
+        return claim([&](id_t id) { ids[count++] = id; }, capacity);
+    }
+
+    //as wait but returns an empty set if no condition was true until the deadline
+    WakeUpSet waitUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        WakeUpSet wakeUpSet;
+        waitAndCollect([&](id_t id) { wakeUpSet.push_back(id); }, SIZE_MAX, deadline);
         return wakeUpSet;
     }
 
+    WakeUpSet waitFor(std::chrono::nanoseconds timeout)
+    {
+        return waitUntil(std::chrono::steady_clock::now() + timeout);
+    }
+
     //Note: filtering the active conditions is a little specific but may be useful
     //could also register the filter to the waitset
+    //the filter is called with the nodes locked (as f of wait)
     WakeUpSet wait(Filter filter)
     {
+        instrumentation::onWaitBegin(this);
         WakeUpSet wakeUpSet;
 
         do
         {
-            m_autoResetEvent.wait();
-            {
-                std::lock_guard g(m_nodesMutex);
+            recheckDelivered();
+            sleep();
 
-                auto n = m_nodes.size();
-                for (size_t id = 0; id < n; ++id)
-                {
-                    WaitNode &node = m_nodes[id];
-                    if (node.getResult())
-                    {
-                        wakeUpSet.push_back(id);
-                        node.reset(); //set condition back to false
-                        // someone may be setting them to true for a second time right now, but we have not fully woken up
-                        // so that is ok (we can see that the condition was true, but not how many times it changed)
-                        // if a new node becomes true there is another notify were it is set to true OR
-                        // we registered it in already in this wakeup
-                    }
-                }
-            }
+            //locked until the callbacks are executed, otherwise the last token of a collected node could remove it
+            std::lock_guard g(m_nodesMutex);
+            m_ready.collect([&](id_t id) {
+                m_nodes[id].reset(); //set condition back to false
+                wakeUpSet.push_back(id);
+            });
 
             wakeUpSet = filter(wakeUpSet);
 
             for (size_t id : wakeUpSet)
             {
-                m_nodes[id].exec();
+                execute(m_nodes[id]);
             }
         } while (wakeUpSet.empty());
 
+        instrumentation::onWaitEnd(this);
         return wakeUpSet;
     }
 
     void notify()
     {
         //we do not need the container mutex here
+        instrumentation::onSignal(this);
         m_autoResetEvent.signal();
     }
 
+    //marks the node ready and wakes the waiter (unless it is already marked or the waiter is awake)
+    void notify(id_t id)
+    {
+        if (m_ready.set(id))
+        {
+            wake();
+        }
+    }
+
+    //notifies all of them but wakes the waiter at most once (e.g. a publisher fanning out to its subscribers),
+    //tokens of other wait sets are notified as usual
+    void notifyMany(WaitToken *tokens, size_t count)
+    {
+        bool marked = false;
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto node = tokens[i].m_waitNode;
+            if (!node)
+            {
+                continue;
+            }
+            if (node->m_waitSet != this)
+            {
+                node->notify();
+            }
+            else if (node->fire())
+            {
+                marked |= m_ready.set(node->id());
+            }
+        }
+        if (marked)
+        {
+            wake();
+        }
+    }
+
 private:
+    friend class WaitNode;
+
     uint64_t m_capacity;
 
     //autoreset event to limit the number of unecessary wake ups
     AutoResetEvent m_autoResetEvent; //must use interprocess internally if used across process boundaries
     Container<WaitNode> m_nodes;
 
+    //ids of the nodes whose condition was true since the last wait
+    ReadySet m_ready;
+
+    //false only while the (single) waiter blocks in wait or is about to, notifiers do not signal an awake waiter
+    //since it looks at the ready set before it blocks again (claim does not use it, i.e. claimers are always signalled)
+    //on its own cache line, it is read by every notifier
+    alignas(64) std::atomic<bool> m_waiterAwake{false};
+
+    //ids of the level triggered nodes whose callbacks ran inline since the last wait
+    ReadySet m_delivered;
+
+    Executor *m_executor{nullptr}; //callbacks are run inline without executor
+
     //protect m_nodes against concurrent modification
     //we can only block the application calling wait, add and remove,
     //but not the one calling notify
@@ -164,26 +276,162 @@ private:
     //we do not want to add this to the container itself, we need a scoped lock for iteration
     std::mutex m_nodesMutex;
 
-    bool remove(id_t id)
+    //without a deadline (time_point::max) we wait until at least one id is collected, otherwise 0 means timed out
+    template <typename F>
+    size_t waitAndCollect(F &&f, size_t maxCount,
+                          std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max())
+    {
+        instrumentation::onWaitBegin(this);
+        size_t count = 0;
+
+        do
+        {
+            recheckDelivered();
+            if (!sleep(deadline))
+            {
+                break; //timed out
+            }
+
+            // find the nodes whose conditions were true
+            // (notify marks them in the ready set, so we only visit those instead of iterating over all nodes)
+
+            std::lock_guard g(m_nodesMutex);
+            count = m_ready.collect(
+                [&](id_t id) {
+                    WaitNode &node = m_nodes[id];
+                    node.reset(); //set condition back to false
+                    // someone may be setting them to true for a second time right now, but we have not fully woken up
+                    // so that is ok (we can see that the condition was true, but not how many times it changed)
+                    // if it becomes true again during the callback, it is marked ready again for the next wait
+                    execute(node);
+                    f(id);
+                },
+                maxCount);
+        } while (count == 0); //do not wake up when no conditions are true
+        //ready ids that are left (maxCount) are seen by the next sleep
+
+        instrumentation::onWaitEnd(this);
+        return count;
+    }
+
+    //signals the event unless the waiter is awake, after marking ids ready
+    void wake()
+    {
+        //seq_cst (as ReadySet::set and any), pairs with sleep: either we see the waiter blocking or it sees our ready ids
+        if (!m_waiterAwake.load(std::memory_order_seq_cst))
+        {
+            notify();
+        }
+    }
+
+    //blocks unless ids became ready since the last collection (without a signal), false if timed out
+    bool sleep(std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max())
+    {
+        m_waiterAwake.store(false, std::memory_order_seq_cst);
+
+        bool signalled = true;
+        if (!m_ready.any())
+        {
+            if (deadline == std::chrono::steady_clock::time_point::max())
+            {
+                m_autoResetEvent.wait();
+            }
+            else
+            {
+                signalled = m_autoResetEvent.waitUntil(deadline);
+            }
+        }
+        m_waiterAwake.store(true, std::memory_order_relaxed);
+        return signalled;
+    }
+
+    //runs the callback inline or dispatches it to the strand of the node
+    void execute(WaitNode &node)
+    {
+        if (!m_executor)
+        {
+            node.exec();
+            if (node.mode() == TriggerMode::LEVEL)
+            {
+                m_delivered.set(node.id());
+            }
+            return;
+        }
+        if (node.schedule())
+        {
+            //the strand keeps the node alive until it is idle again
+            node.incrementRefCount();
+            m_executor->post([this, &node] { runStrand(node); });
+        }
+    }
+
+    void runStrand(WaitNode &node)
+    {
+        do
+        {
+            node.exec();
+        } while (node.reschedule()); //dispatched again while running, run once more
+        if (node.mode() == TriggerMode::LEVEL)
+        {
+            node.notify(); //still true, dispatch it again
+        }
+        release(node);
+    }
+
+    //level triggered nodes that were delivered are ready again if their condition is still true,
+    //called before blocking, i.e. after the caller processed the previous result (as epoll does)
+    void recheckDelivered()
     {
+        if (!m_delivered.any())
+        {
+            return;
+        }
         std::lock_guard g(m_nodesMutex);
-        auto &node = m_nodes[id];
+        m_delivered.collect([&](id_t id) { m_nodes[id].notify(); });
+    }
 
-        //only remove it if no token references it anymore
-        if (node.numReferences() <= 0)
+    //references are taken from 0 and dropped to 0 only with the nodes locked (by execute and claimNode,
+    //others hold a reference already), the last one removes the node in the same step
+    //claims one ready id and keeps its node alive until release (like a token)
+    WaitNode *claimNode()
+    {
+        std::lock_guard g(m_nodesMutex);
+        WaitNode *node = nullptr;
+        m_ready.claim(
+            [&](id_t id) {
+                node = &m_nodes[id];
+                node->reset(); //set condition back to false
+                node->incrementRefCount();
+            },
+            1);
+        return node;
+    }
+
+    void release(WaitNode &node)
+    {
+        std::lock_guard g(m_nodesMutex);
+        if (node.decrementRefCount() == 0)
         {
-            return m_nodes.remove(id);
+            //the last token, or all tokens were destroyed while the callback was running
+            auto id = node.id();
+            m_ready.reset(id);
+            m_delivered.reset(id);
+            m_nodes.remove(id);
         }
-        return false;
     }
 };
 
 //can only be defined when WaitSet is fully defined
 void WaitNode::notify()
 {
-    if (evalMonotonic()) //is or was true and not yet reset
+    if (fire()) //is or was true and not yet reset (and not fired yet if one-shot)
     {
         //notify only if the condition is true
-        m_waitSet->notify();
+        m_waitSet->notify(m_id);
     }
+}
+
+void WaitNode::release()
+{
+    m_waitSet->release(*this);
 }
\ No newline at end of file
@@ -4,14 +4,30 @@
 #include <functional>
 #include <stdint.h>
 
+#include "inplace_function.hpp"
+
+#ifndef CP_WAITSET_FUNCTION_CAPACITY
+#define CP_WAITSET_FUNCTION_CAPACITY 48 //bytes of captured state of conditions and callbacks
+#endif
+
 using id_t = uint32_t;
 
-//storing more specific conditions can be done without std::function (and thus without dynamic memory)
-using Callback = std::function<void(void)>;
-using Condition = std::function<bool(void)>;
+//stored in the nodes themselves (add does not allocate, the nodes are contiguous),
+//larger conditions and callbacks do not compile (capture a pointer to their state instead)
+using Callback = InplaceFunction<void(void), CP_WAITSET_FUNCTION_CAPACITY>;
+using Condition = InplaceFunction<bool(void), CP_WAITSET_FUNCTION_CAPACITY>;
 
 using WakeUpSet = std::vector<id_t>;
 
+//when a condition is delivered by wait (or claim)
+enum class TriggerMode
+{
+    EDGE,    //once per notify that finds the condition true
+    LEVEL,   //again by every following wait as long as the condition is still true (re-checked before blocking),
+             //i.e. a subscriber that drains only part of its queue per callback does not need to notify again
+    ONE_SHOT //once, then notifications are ignored until the token is rearmed
+};
+
 //in general a filter cannot just depend on a single id_t but the whole wake-up set
 using Filter = std::function<WakeUpSet(WakeUpSet &)>;
 
@@ -76,6 +76,12 @@ public:
         m_waitNode->notify();
     }
 
+    //one-shot only, enables the condition again after it was delivered
+    void rearm()
+    {
+        m_waitNode->rearm();
+    }
+
     bool isValid()
     {
         return m_waitNode != nullptr;
@@ -85,11 +91,9 @@ public:
     {
         if (isValid())
         {
-            m_waitNode->decrementRefCount();
-            if (m_waitNode->numReferences() <= 0)
-            {
-                m_waitNode->tryDelete();
-            }
+            //the last reference is dropped and the node removed in one step under the lock of the wait set,
+            //a claimer or strand may take a reference concurrently (and then removes it on release)
+            m_waitNode->release();
             m_waitNode = nullptr;
         }
     }
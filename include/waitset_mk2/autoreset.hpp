@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 
 template <typename Semaphore>
 class AutoResetEvent;
@@ -64,6 +65,34 @@ public:
         }
     }
 
+    //returns false if not signalled until the deadline (requires Semaphore::waitUntil)
+    bool waitUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        auto count = m_count.fetch_sub(1, std::memory_order_relaxed);
+        if (count >= 1)
+        {
+            return true;
+        }
+        if (m_semaphore->waitUntil(deadline))
+        {
+            return true;
+        }
+
+        //timed out, but a signal may have been sent to us in the meantime
+        //either we are still counted as a waiter (count < 0) and remove ourselves,
+        //or the signaller has already posted the semaphore for us and we consume the post
+        count = m_count.load(std::memory_order_relaxed);
+        while (count < 0)
+        {
+            if (m_count.compare_exchange_weak(count, count + 1, std::memory_order_relaxed, std::memory_order_relaxed))
+            {
+                return false;
+            }
+        }
+        m_semaphore->wait(); //returns immediately (or very soon)
+        return true;
+    }
+
 private:
     Semaphore *m_semaphore; //after construction will always be a pointer (life time not controlled here though)
     //m_count is always <= 1, with 1 indicating it was signalled
@@ -110,4 +139,72 @@ public:
 
 private:
     Semaphore *m_semaphore; //responsible for semaphore lifetime
-};
\ No newline at end of file
+};
+
+//owns the semaphore in place instead of by pointer, i.e. the event is position independent and can be placed
+//in shared memory if the semaphore can (e.g. the futex based Semaphore)
+template <typename Semaphore>
+class InplaceAutoResetEvent
+{
+public:
+    InplaceAutoResetEvent(int64_t initialCount = 0) : m_count(initialCount < 1 ? initialCount : 1)
+    {
+    }
+
+    InplaceAutoResetEvent(const InplaceAutoResetEvent &) = delete;
+    InplaceAutoResetEvent(InplaceAutoResetEvent &&) = delete;
+
+    void signal()
+    {
+        auto count = m_count.load(std::memory_order_relaxed);
+        do
+        {
+            auto newCount = count < 1 ? count + 1 : 1; // saturates
+            if (m_count.compare_exchange_weak(count, newCount, std::memory_order_release, std::memory_order_relaxed))
+            {
+                break;
+            }
+        } while (true);
+
+        if (count < 0)
+        {
+            m_semaphore.post();
+        }
+    }
+
+    void wait()
+    {
+        auto count = m_count.fetch_sub(1, std::memory_order_relaxed);
+        if (count < 1)
+        {
+            m_semaphore.wait();
+        }
+    }
+
+    //returns false if not signalled until the deadline (requires Semaphore::waitUntil)
+    bool waitUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        auto count = m_count.fetch_sub(1, std::memory_order_relaxed);
+        if (count >= 1 || m_semaphore.waitUntil(deadline))
+        {
+            return true;
+        }
+
+        //timed out, remove ourselves as waiter or consume the post of a signal that was sent in the meantime
+        count = m_count.load(std::memory_order_relaxed);
+        while (count < 0)
+        {
+            if (m_count.compare_exchange_weak(count, count + 1, std::memory_order_relaxed, std::memory_order_relaxed))
+            {
+                return false;
+            }
+        }
+        m_semaphore.wait(); //returns immediately (or very soon)
+        return true;
+    }
+
+private:
+    //same states as GenericAutoResetEvent
+    std::atomic<int64_t> m_count;
+    Semaphore m_semaphore;
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include "types.hpp"
+#include "notifyable.hpp"
+
+namespace ws
+{
+
+//Signaller for a WaitSet that also waits for file descriptors
+//
+//the waiter blocks in epoll_wait on an internal epoll instance containing an eventfd and the attached fds,
+//ready fds are turned into notifications of their triggers (by the waiter, via the Notifyable target)
+//
+//signal has the semantics of an auto reset event and stays in user space unless the waiter is parked in epoll,
+//only then the eventfd is written (once per park)
+//
+//the epoll fd itself is pollable, i.e. the wait set can be nested in an outer poll loop (see beginExternalWait)
+class EpollSignaller
+{
+public:
+    EpollSignaller()
+    {
+        m_epoll = epoll_create1(EPOLL_CLOEXEC);
+        m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = WAKE_UP;
+        if (m_epoll < 0 || m_eventFd < 0 || epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_eventFd, &event) != 0)
+        {
+            std::terminate(); //the wait set cannot work without it
+        }
+    }
+
+    ~EpollSignaller()
+    {
+        close(m_eventFd);
+        close(m_epoll);
+    }
+
+    EpollSignaller(const EpollSignaller &) = delete;
+    EpollSignaller(EpollSignaller &&) = delete;
+
+    //receives the notifications of ready fds, set by the wait set before any fd is added
+    void setTarget(Notifyable *target)
+    {
+        m_target = target;
+    }
+
+    int fd() const
+    {
+        return m_epoll;
+    }
+
+    //level triggered, i.e. the trigger is notified on every wait while the fd is ready
+    bool add(int fd, uint32_t events, index_t index, id_t id)
+    {
+        std::lock_guard<std::mutex> g(m_fdsMutex);
+        epoll_event event{};
+        event.events = events;
+        event.data.u64 = uint64_t(index) << 32 | static_cast<uint32_t>(id); //the tag of the id suffices for notify
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            return false;
+        }
+        if (m_fds.size() <= index)
+        {
+            m_fds.resize(index + 1);
+        }
+        m_fds[index] = {fd, id};
+        return true;
+    }
+
+    //removes the fd of the trigger (if any), i.e. only if it is still attached at index with this id
+    void remove(index_t index, id_t id)
+    {
+        std::lock_guard<std::mutex> g(m_fdsMutex);
+        if (index < m_fds.size() && m_fds[index].fd != NO_FD && m_fds[index].id == id)
+        {
+            epoll_ctl(m_epoll, EPOLL_CTL_DEL, m_fds[index].fd, nullptr);
+            m_fds[index] = {};
+        }
+    }
+
+    void signal()
+    {
+        auto count = m_count.load(std::memory_order_relaxed);
+        do
+        {
+            auto newCount = count < 1 ? count + 1 : 1; // saturates
+            if (m_count.compare_exchange_weak(count, newCount, std::memory_order_release, std::memory_order_relaxed))
+            {
+                break;
+            }
+        } while (true);
+
+        if (count < 0)
+        {
+            //the waiter is parked in epoll
+            uint64_t one = 1;
+            [[maybe_unused]] auto result = write(m_eventFd, &one, sizeof(one));
+        }
+    }
+
+    void wait()
+    {
+        if (m_count.fetch_sub(1, std::memory_order_acquire) >= 1)
+        {
+            //fast path, but look at the fds from time to time, they would starve otherwise
+            if (++m_fastPathWaits % FD_POLL_INTERVAL == 0)
+            {
+                dispatch(0);
+            }
+            return;
+        }
+        park(-1);
+    }
+
+    //returns false if not signalled and no fd was ready until the deadline
+    bool waitUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        if (m_count.fetch_sub(1, std::memory_order_acquire) >= 1)
+        {
+            return true;
+        }
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        return park(remaining.count() > 0 ? static_cast<int>(std::min<int64_t>(remaining.count(), INT32_MAX)) : 0);
+    }
+
+    //for an outer poll loop which polls fd() instead of calling wait:
+    //returns false if there are pending notifications (collect them without polling),
+    //otherwise signal writes the eventfd from now on and endExternalWait must be called after polling
+    bool beginExternalWait()
+    {
+        int64_t idle = 0;
+        if (m_count.compare_exchange_strong(idle, -1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return true;
+        }
+        //signalled (1), consume it
+        m_count.store(0, std::memory_order_relaxed);
+        return false;
+    }
+
+    //turns ready fds into notifications, afterwards the notifications can be collected (e.g. waitFor(0))
+    void endExternalWait()
+    {
+        unpark();
+        dispatch(0);
+    }
+
+private:
+    static constexpr uint64_t WAKE_UP = UINT64_MAX;
+    static constexpr int NO_FD = -1;
+    static constexpr int MAX_EVENTS = 64;
+    static constexpr uint32_t FD_POLL_INTERVAL = 64;
+
+    int m_epoll{-1};
+    int m_eventFd{-1};
+    Notifyable *m_target{nullptr};
+
+    //as AutoResetEvent: 1 signalled, 0 not signalled, -1 the (single) waiter is parked in epoll
+    std::atomic<int64_t> m_count{0};
+    uint32_t m_fastPathWaits{0};
+
+    struct FdInfo
+    {
+        int fd{NO_FD};
+        id_t id{INVALID_ID};
+    };
+
+    std::mutex m_fdsMutex; //add and remove only, not needed for waiting
+    std::vector<FdInfo> m_fds; //by trigger index
+
+    //the parked waiter is no longer counted, false if a signal did this already
+    bool unpark()
+    {
+        auto count = m_count.load(std::memory_order_relaxed);
+        while (count < 0)
+        {
+            if (m_count.compare_exchange_weak(count, count + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //precondition: m_count was decremented by the waiter, returns false if nothing happened until the timeout
+    bool park(int timeoutMs)
+    {
+        epoll_event events[MAX_EVENTS];
+        int n = epoll_wait(m_epoll, events, MAX_EVENTS, timeoutMs);
+
+        //no longer parked before the fds are dispatched, i.e. their notifications do not write the eventfd
+        bool signalled = !unpark();
+        handle(events, n);
+        return n != 0 || signalled;
+    }
+
+    void dispatch(int timeoutMs)
+    {
+        epoll_event events[MAX_EVENTS];
+        int n = epoll_wait(m_epoll, events, MAX_EVENTS, timeoutMs);
+        handle(events, n);
+    }
+
+    void handle(epoll_event *events, int n)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            auto data = events[i].data.u64;
+            if (data == WAKE_UP)
+            {
+                uint64_t value;
+                [[maybe_unused]] auto result = read(m_eventFd, &value, sizeof(value));
+            }
+            else if (m_target)
+            {
+                m_target->notify(static_cast<index_t>(data >> 32), static_cast<id_t>(static_cast<uint32_t>(data)));
+            }
+        }
+    }
+};
+
+} // namespace ws
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+#include "types.hpp"
+
+namespace ws
+{
+
+//lock-free pool of the indices 0, ..., Capacity - 1 (a Treiber stack over a fixed array)
+//the head is tagged with a counter that changes with every push and pop, which prevents ABA
+//(a pop that read a stale next index fails its compare exchange)
+template <uint32_t Capacity>
+class IndexPool
+{
+public:
+    IndexPool()
+    {
+        for (index_t i = 0; i < Capacity; ++i)
+        {
+            m_next[i].store(i + 1 < Capacity ? i + 1 : INVALID_INDEX, std::memory_order_relaxed);
+        }
+        m_head.store(toHead(0, Capacity > 0 ? 0 : INVALID_INDEX), std::memory_order_release);
+    }
+
+    IndexPool(const IndexPool &) = delete;
+    IndexPool(IndexPool &&) = delete;
+
+    //the first pops return 0, 1, 2, ... (nullopt if the pool is empty)
+    std::optional<index_t> pop()
+    {
+        auto head = m_head.load(std::memory_order_acquire);
+        while (true)
+        {
+            auto index = indexOf(head);
+            if (index == INVALID_INDEX)
+            {
+                return std::nullopt;
+            }
+            //may be stale if someone else popped index concurrently, the tag check below fails then
+            auto next = m_next[index].load(std::memory_order_relaxed);
+            if (m_head.compare_exchange_weak(head, toHead(tagOf(head) + 1, next), std::memory_order_acquire,
+                                             std::memory_order_acquire))
+            {
+                return index;
+            }
+        }
+    }
+
+    //precondition: index was popped before (and is pushed only once)
+    void push(index_t index)
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        do
+        {
+            m_next[index].store(indexOf(head), std::memory_order_relaxed);
+        } while (!m_head.compare_exchange_weak(head, toHead(tagOf(head) + 1, index), std::memory_order_release,
+                                               std::memory_order_relaxed));
+    }
+
+private:
+    std::array<std::atomic<index_t>, Capacity> m_next;
+    std::atomic<uint64_t> m_head; //tag << 32 | index
+
+    static uint64_t toHead(uint32_t tag, index_t index)
+    {
+        return (uint64_t(tag) << 32) | index;
+    }
+
+    static uint32_t tagOf(uint64_t head)
+    {
+        return static_cast<uint32_t>(head >> 32);
+    }
+
+    static index_t indexOf(uint64_t head)
+    {
+        return static_cast<index_t>(head);
+    }
+};
+
+} // namespace ws
@@ -9,7 +9,8 @@ class Notifyable
 {
 public:
     virtual void notify() = 0;
-    virtual void notify(index_t) = 0;
+    //the id identifies the attachment of the trigger at index, notifications with outdated ids are ignored
+    virtual void notify(index_t, id_t) = 0;
 };
 
 } // namespace ws
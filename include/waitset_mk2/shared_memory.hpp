@@ -0,0 +1,135 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace ws
+{
+
+//a named POSIX shared memory segment mapped into this process
+//the segment is mapped at a different address in each process, objects in it are addressed by their offset
+//(and hence must not contain pointers, e.g. SharedWaitSet)
+//
+//the creator removes the name on destruction, processes that have opened the segment keep their mapping
+class SharedMemory
+{
+public:
+    //fails if the name exists already, the memory is zero initialized
+    static std::optional<SharedMemory> create(const std::string &name, size_t size)
+    {
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+        if (fd < 0)
+        {
+            return std::nullopt;
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+        {
+            close(fd);
+            shm_unlink(name.c_str());
+            return std::nullopt;
+        }
+        auto memory = map(fd, size);
+        if (!memory)
+        {
+            shm_unlink(name.c_str());
+            return std::nullopt;
+        }
+        return SharedMemory(name, memory, size, true);
+    }
+
+    static std::optional<SharedMemory> open(const std::string &name)
+    {
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+        {
+            return std::nullopt;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            close(fd);
+            return std::nullopt;
+        }
+        auto size = static_cast<size_t>(info.st_size);
+        auto memory = map(fd, size);
+        if (!memory)
+        {
+            return std::nullopt;
+        }
+        return SharedMemory(name, memory, size, false);
+    }
+
+    ~SharedMemory()
+    {
+        if (m_base)
+        {
+            munmap(m_base, m_size);
+            if (m_owner)
+            {
+                shm_unlink(m_name.c_str());
+            }
+        }
+    }
+
+    SharedMemory(const SharedMemory &) = delete;
+
+    SharedMemory(SharedMemory &&other)
+        : m_name(std::move(other.m_name)), m_base(std::exchange(other.m_base, nullptr)), m_size(other.m_size), m_owner(other.m_owner)
+    {
+    }
+
+    void *base() const
+    {
+        return m_base;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    //precondition: address is in the segment
+    uint64_t offsetOf(const void *address) const
+    {
+        return static_cast<uint64_t>(static_cast<const char *>(address) - static_cast<const char *>(m_base));
+    }
+
+    //nullptr if a T at offset would not be (completely) in the segment or is misaligned
+    template <typename T>
+    T *at(uint64_t offset) const
+    {
+        if (offset > m_size || m_size - offset < sizeof(T) || offset % alignof(T) != 0)
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<T *>(static_cast<char *>(m_base) + offset);
+    }
+
+private:
+    std::string m_name;
+    void *m_base{nullptr};
+    size_t m_size{0};
+    bool m_owner{false};
+
+    SharedMemory(const std::string &name, void *base, size_t size, bool owner)
+        : m_name(name), m_base(base), m_size(size), m_owner(owner)
+    {
+    }
+
+    //closes the fd, the mapping stays valid
+    static void *map(int fd, size_t size)
+    {
+        auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        return memory == MAP_FAILED ? nullptr : memory;
+    }
+};
+
+} // namespace ws
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+
+#include "semaphore.hpp"
+#include "waitset_core.hpp"
+#include "autoreset.hpp"
+#include "shared_memory.hpp"
+
+namespace ws
+{
+
+template <uint32_t MaxTriggers>
+class SharedWaitSet;
+
+//identifies a trigger by the offset of its wait set in a shared memory segment and its index (and id),
+//i.e. it is plain data and can be stored in the segment itself or sent to other processes
+template <uint32_t MaxTriggers>
+class SharedTrigger
+{
+public:
+    //the segment is the mapping of the calling process, ignored if not attached (or detached in the meantime)
+    void trigger(const SharedMemory &memory) const
+    {
+        auto waitSet = memory.at<SharedWaitSet<MaxTriggers>>(offset);
+        if (waitSet && id != INVALID_ID)
+        {
+            waitSet->notify(index, id);
+        }
+    }
+
+    bool isAttached() const
+    {
+        return id != INVALID_ID;
+    }
+
+private:
+    friend class SharedWaitSet<MaxTriggers>;
+
+    uint64_t offset{0};
+    index_t index{INVALID_INDEX};
+    id_t id{INVALID_ID};
+};
+
+//wait set that lives in a shared memory segment, with its trigger table, counters and signaller,
+//notifying it only needs atomics and the futex of its semaphore (which is shared by all processes mapping it)
+//
+//the owner constructs it in the segment (placement new) and waits, other processes trigger it with SharedTriggers
+//(there must be only one waiting thread across all processes)
+template <uint32_t MaxTriggers = 128>
+class SharedWaitSet : private WaitSetCore<MaxTriggers, InplaceAutoResetEvent<Semaphore>>
+{
+    using Core = WaitSetCore<MaxTriggers, InplaceAutoResetEvent<Semaphore>>;
+
+public:
+    using Core::notify;
+    using Core::setDelivery;
+    using Core::wait;
+    using Core::waitFor;
+    using Core::waitUntil;
+
+    SharedWaitSet()
+    {
+    }
+
+    //memory is the segment the wait set is placed in (mapped in the calling process)
+    //false if the trigger is already attached or all MaxTriggers are in use (or the priority is invalid)
+    bool attach(SharedTrigger<MaxTriggers> &trigger, const SharedMemory &memory,
+                priority_t priority = LOWEST_PRIORITY)
+    {
+        if (trigger.isAttached())
+        {
+            return false;
+        }
+
+        auto result = Core::attach(priority);
+        if (!result.has_value())
+        {
+            return false;
+        }
+
+        trigger.offset = memory.offsetOf(this);
+        trigger.index = result->index;
+        trigger.id = result->id;
+        return true;
+    }
+
+    //pending notifications of the trigger are dropped, later trigger calls (e.g. of copies) are ignored
+    bool detach(SharedTrigger<MaxTriggers> &trigger)
+    {
+        if (!Core::detach(trigger.index, trigger.id))
+        {
+            return false;
+        }
+
+        trigger.index = INVALID_INDEX;
+        trigger.id = INVALID_ID;
+        return true;
+    }
+};
+
+} // namespace ws
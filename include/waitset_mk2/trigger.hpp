@@ -12,18 +12,27 @@ class WaitSet;
 class Trigger
 {
 public:
+    //ignored if not attached (or detached in the meantime)
     void trigger()
     {
-        notifyable->notify(index);
+        if (notifyable)
+        {
+            notifyable->notify(index, id);
+        }
+    }
+
+    bool isAttached() const
+    {
+        return notifyable != nullptr;
     }
 
 private:
     template <uint32_t MaxTriggers, typename SemaphoreType>
     friend class WaitSet;
 
-    Notifyable *notifyable;
-    index_t index;
-    id_t id; //make this a monotoic counter, set by the waitset as a static
+    Notifyable *notifyable{nullptr};
+    index_t index{INVALID_INDEX};
+    id_t id{INVALID_ID}; //monotonic counter, set by the waitset on attach
 };
 
 } // namespace ws
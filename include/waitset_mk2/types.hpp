@@ -1,13 +1,23 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 
 namespace ws
 {
 
 using id_t = uint64_t;
 using index_t = uint32_t;
+using priority_t = uint8_t;
 
-constexpr id_t RESERVED_INDEX = 0;
-constexpr id_t INVALID_INDEX = 0;
+constexpr index_t RESERVED_INDEX = 0;
+constexpr index_t INVALID_INDEX = std::numeric_limits<index_t>::max();
 constexpr id_t INVALID_ID = 0;
+
+//notifications of higher priorities are delivered first, at most 64 levels (one bit each in the ready bitmap)
+constexpr uint32_t NUM_PRIORITIES = 8;
+constexpr priority_t LOWEST_PRIORITY = 0;
+constexpr priority_t HIGHEST_PRIORITY = NUM_PRIORITIES - 1;
+
+constexpr size_t CACHE_LINE_SIZE = 64;
 } // namespace ws
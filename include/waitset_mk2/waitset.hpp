@@ -1,42 +1,46 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
-#include <atomic>
+#include <type_traits>
 
 #include "trigger.hpp"
 #include "notifyable.hpp"
 #include "semaphore.hpp"
-#include "container.hpp"
+#include "waitset_core.hpp"
 #include "autoreset.hpp"
+#include "epoll_signaller.hpp"
 
 namespace ws
 {
 
-struct NotificationInfo
-{
-    index_t index;
-};
-
-struct TriggerInfo
-{
-    TriggerInfo() = default;
-    NotificationInfo notificationInfo;
-    id_t id;
-    uint64_t numNotified{0};
-    //std::atomic<uint64_t> notified; //fix forwarding to use this
-};
-
 //we want to use some Signaller "concept"
-//cannot be stored in shared memory like this, can be redesigned to use a non-virtual interface if needed
+//cannot be stored in shared memory like this (Notifyable is virtual and the Trigger holds a pointer),
+//see SharedWaitSet for a wait set in shared memory
+//
+//with the EpollSignaller, file descriptors can be attached as triggers and the wait set can be polled
+//(the fd functions are only available with it)
+//
+//attach, detach, notify (Trigger::trigger) are lock-free and can be called from any thread concurrently with wait
+//(but a single Trigger object must not be attached, detached and triggered concurrently)
 template <uint32_t MaxTriggers = 128, typename Signaller = AutoResetEvent<Semaphore>>
 class WaitSet
-    : public Notifyable
+    : public Notifyable,
+      private WaitSetCore<MaxTriggers, Signaller>
 {
+    using Core = WaitSetCore<MaxTriggers, Signaller>;
+
 public:
-    WaitSet() : m_triggerInfoContainer(MaxTriggers)
+    using Core::setDelivery;
+    using Core::wait;
+    using Core::waitFor;
+    using Core::waitUntil;
+
+    WaitSet()
     {
-        attach(m_internalTrigger); //TODO ensure it is the 0 trigger
+        if constexpr (std::is_same_v<Signaller, EpollSignaller>)
+        {
+            Core::signaller().setTarget(this);
+        }
     }
 
     ~WaitSet()
@@ -45,115 +49,128 @@ public:
 
     void notify() override
     {
-        //or just signal but then we cannot have the non-empty wakeup container
-        notify(RESERVED_INDEX);
+        Core::notify();
     }
 
-    //TODO: make attach/detach thread safe (lock-free?)
-    bool attach(Trigger &trigger)
+    //triggers all of them but wakes the waiter at most once (e.g. a publisher fanning out to its subscribers),
+    //triggers attached to other wait sets are triggered as usual
+    void notifyMany(Trigger *triggers, size_t count)
     {
-        //TODO check whether it is already attached
-        auto result = m_triggerInfoContainer.emplace();
-        if (!result.has_value())
+        bool wake = false;
+        for (size_t i = 0; i < count; ++i)
         {
-            return false;
+            auto &trigger = triggers[i];
+            if (trigger.notifyable == this)
+            {
+                wake |= Core::markReady(trigger.index, trigger.id);
+            }
+            else
+            {
+                trigger.trigger();
+            }
+        }
+        if (wake)
+        {
+            Core::wake();
         }
-
-        index_t index = result.value();
-        TriggerInfo &info = m_triggerInfoContainer[index];
-
-        trigger.id = generateTriggerId();
-        info.id = trigger.id;
-        info.notificationInfo.index = index;
-
-        m_triggerIndices.push_back(index); //TODO cannot remove currently, implement detach
-        return true;
     }
 
-    void detach(Trigger &trigger)
+    //false if the trigger is already attached (here or elsewhere) or all MaxTriggers are in use
+    //(or the priority is not below NUM_PRIORITIES)
+    bool attach(Trigger &trigger, priority_t priority = LOWEST_PRIORITY)
     {
-        //TODO implement
-        index_t index = trigger.index;
-        if (index == INVALID_INDEX)
+        if (trigger.notifyable != nullptr)
         {
-            return;
+            return false;
         }
 
-        //if(trigger.id matches id in notification array of the same index)
-
-        trigger.index = INVALID_INDEX;
-
-        //remove from container if it exists
+        auto result = Core::attach(priority);
+        if (!result.has_value())
+        {
+            return false;
+        }
 
-        trigger.index == INVALID_INDEX;
+        trigger.id = result->id;
+        trigger.index = result->index;
+        trigger.notifyable = this;
+        return true;
     }
 
-    std::vector<NotificationInfo *> wait()
+    //the trigger is notified by the waiter whenever fd is ready (level triggered) for one of the epoll events
+    //(but can also be triggered as usual), the fd must stay open until the trigger is detached
+    //(only with the EpollSignaller, otherwise attach(trigger, priority) would be ambiguous with an int priority)
+    template <typename S = Signaller, typename = std::enable_if_t<std::is_same_v<S, EpollSignaller>>>
+    bool attach(Trigger &trigger, int fd, uint32_t events = EPOLLIN, priority_t priority = LOWEST_PRIORITY)
     {
-        std::vector<NotificationInfo *> result = collectNotifications();
-
-        while (result.empty())
+        if (!attach(trigger, priority))
         {
-            signaller.wait();
-            result = collectNotifications();
+            return false;
         }
-        //always non-empty
-        return result;
+        if (!Core::signaller().add(fd, events, trigger.index, trigger.id))
+        {
+            detach(trigger);
+            return false;
+        }
+        return true;
     }
 
-    //TODO timed wait
-
-private:
-    friend class Trigger;
-    Signaller signaller;
-    Trigger m_internalTrigger; //reserve index 0 for internal wake up trigger
-
-    //TODO: if using a lock-free index pool, could be made lock-free
-    IndexedContainer<TriggerInfo> m_triggerInfoContainer; //TODO: size template arg for container
-    std::vector<index_t> m_triggerIndices;
+    //pending notifications of the trigger are dropped, later trigger calls (e.g. of copies) are ignored
+    bool detach(Trigger &trigger)
+    {
+        if (trigger.notifyable != this)
+        {
+            return false;
+        }
+        if constexpr (std::is_same_v<Signaller, EpollSignaller>)
+        {
+            Core::signaller().remove(trigger.index, trigger.id);
+        }
+        if (!Core::detach(trigger.index, trigger.id))
+        {
+            return false;
+        }
 
-    static std::atomic<id_t> s_triggerId;
+        trigger.notifyable = nullptr;
+        trigger.index = INVALID_INDEX;
+        trigger.id = INVALID_ID;
+        return true;
+    }
 
-    static id_t generateTriggerId()
+    //readable if the wait set has notifications (or an attached fd is ready) while the owner is in an outer poll:
+    //if (beginExternalWait()) { poll(..., fd(), ...); endExternalWait(); } auto notifications = waitFor(0);
+    int fd() const
     {
-        id_t id;
-        do
-        {
-            id = s_triggerId.fetch_add(1, std::memory_order_relaxed);
-        } while (id == INVALID_ID);
-        return id;
+        return Core::signaller().fd();
     }
 
-    std::vector<NotificationInfo *> collectNotifications()
+    //false if there are pending notifications, the owner collects them instead of polling then
+    bool beginExternalWait()
     {
-        std::vector<NotificationInfo *> notifications;
-        for (auto index : m_triggerIndices)
+        if (!Core::beginSleep())
         {
-            //TODO better container abstraction for use case
-            auto &info = m_triggerInfoContainer[index];
-            //TODO fetch_sub when atomics are used (fix forwarding)
-            if (info.numNotified > 0)
-            {
-                info.numNotified--;
-                notifications.push_back(&info.notificationInfo);
-            }
+            return false;
+        }
+        if (!Core::signaller().beginExternalWait())
+        {
+            Core::endSleep();
+            return false;
         }
-        return notifications;
+        return true;
     }
 
-    void notify(index_t index) override
+    void endExternalWait()
     {
-        TriggerInfo &info = m_triggerInfoContainer[index];
-
-        //TODO check for id match
-        info.numNotified++;
-        signaller.signal();
+        Core::endSleep();
+        Core::signaller().endExternalWait();
     }
 
-}; // namespace ws
+private:
+    friend class Trigger;
 
-//monotonic, to be reasonably sure we idenfified the correct trigger (modulo wraparound)
-template <uint32_t M, typename S>
-std::atomic<id_t> WaitSet<M, S>::s_triggerId{1};
+    void notify(index_t index, id_t id) override
+    {
+        Core::notify(index, id);
+    }
+};
 
 } // namespace ws
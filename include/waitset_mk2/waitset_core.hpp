@@ -0,0 +1,423 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <atomic>
+#include <type_traits>
+
+#include "types.hpp"
+#include "index_pool.hpp"
+#include "instrumentation/probes.hpp"
+
+namespace ws
+{
+
+struct NotificationInfo
+{
+    index_t index;
+    uint64_t count{0}; //notifications since the last wait that returned this trigger
+    priority_t priority{LOWEST_PRIORITY};
+};
+
+struct TriggerInfo
+{
+    TriggerInfo() = default;
+    NotificationInfo notificationInfo;
+};
+
+struct Attachment
+{
+    index_t index;
+    id_t id;
+};
+
+enum class Delivery
+{
+    ALL,             //all notified triggers, highest priority first
+    HIGHEST_PRIORITY //only the triggers of the highest notified priority, the others are returned by the next wait
+};
+
+//the notification logic of the wait sets, without virtual functions and pointers (and not static members),
+//i.e. it is position independent and can be placed in shared memory if the Signaller can
+//
+//triggers are identified by (index, id) only, the wait sets wrap this into their trigger types
+//the index RESERVED_INDEX is attached on construction (with the highest priority) and notified by notify()
+//
+//a wait returns the notified triggers grouped by priority, highest first (by index within a priority)
+//
+//notifications are coalesced: only the first notification of a trigger that is not collected yet and only
+//while the waiter is blocked (or about to block) signal it, i.e. notifying a running waiter costs no signal
+//
+//attach, detach, notify are lock-free and can be called from any thread concurrently with wait
+template <uint32_t MaxTriggers, typename Signaller>
+class WaitSetCore
+{
+    static_assert(NUM_PRIORITIES <= 64, "one bit per priority in the ready bitmap");
+    static_assert(MaxTriggers <= 64 * 64, "one bit per summary word in the ready bitmap");
+
+public:
+    WaitSetCore()
+    {
+        //the index of a slot never changes, i.e. the waiter can read the infos while triggers are attached
+        for (index_t index = 0; index < MaxTriggers; ++index)
+        {
+            m_triggerInfos[index].notificationInfo.index = index;
+        }
+        m_internalId = attach(HIGHEST_PRIORITY)->id; //the first index of the pool, i.e. RESERVED_INDEX
+    }
+
+    WaitSetCore(const WaitSetCore &) = delete;
+    WaitSetCore(WaitSetCore &&) = delete;
+
+    void notify()
+    {
+        //or just signal but then we cannot have the non-empty wakeup container
+        notify(RESERVED_INDEX, m_internalId);
+    }
+
+    //the id identifies the attachment of the trigger at index, notifications with outdated ids are ignored
+    void notify(index_t index, id_t id)
+    {
+        if (markReady(index, id))
+        {
+            wake();
+        }
+    }
+
+    //nullopt if all MaxTriggers are in use (or the priority is invalid)
+    std::optional<Attachment> attach(priority_t priority = LOWEST_PRIORITY)
+    {
+        if (priority >= NUM_PRIORITIES)
+        {
+            return std::nullopt;
+        }
+        auto result = m_indexPool.pop();
+        if (!result.has_value())
+        {
+            return std::nullopt;
+        }
+
+        index_t index = result.value();
+        auto id = generateTriggerId();
+        m_priorities[index].store(priority, std::memory_order_relaxed);
+        //publishes the trigger (and its priority), notifications with older ids of the same index are ignored from now on
+        m_counters[index].store(uint64_t(tagOf(id)) << 32, std::memory_order_release);
+        return Attachment{index, id};
+    }
+
+    //pending notifications of the trigger are dropped, later notifications with this id are ignored
+    bool detach(index_t index, id_t id)
+    {
+        if (index >= MaxTriggers || index == RESERVED_INDEX)
+        {
+            return false;
+        }
+
+        auto &counter = m_counters[index];
+        auto value = counter.load(std::memory_order_relaxed);
+        do
+        {
+            if (tag(value) != tagOf(id))
+            {
+                return false; //not (or no longer) attached with this id
+            }
+        } while (!counter.compare_exchange_weak(value, 0, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        m_indexPool.push(index);
+        return true;
+    }
+
+    std::vector<NotificationInfo *> wait()
+    {
+        std::vector<NotificationInfo *> result;
+        wait([&](NotificationInfo &info) { result.push_back(&info); });
+        //always non-empty
+        return result;
+    }
+
+    //as wait but returns an empty result if there was no notification until the deadline
+    std::vector<NotificationInfo *> waitUntil(std::chrono::steady_clock::time_point deadline)
+    {
+        std::vector<NotificationInfo *> result;
+        waitAndCollect([&](NotificationInfo &info) { result.push_back(&info); }, SIZE_MAX, deadline);
+        return result;
+    }
+
+    std::vector<NotificationInfo *> waitFor(std::chrono::nanoseconds timeout)
+    {
+        return waitUntil(std::chrono::steady_clock::now() + timeout);
+    }
+
+    //does not allocate: copies at most capacity notifications into the buffer and returns their number (> 0),
+    //notifications that do not fit are returned by the next wait (which does not block)
+    size_t wait(NotificationInfo *buffer, size_t capacity)
+    {
+        if (capacity == 0)
+        {
+            return 0;
+        }
+        size_t count = 0;
+        waitAndCollect([&](NotificationInfo &info) { buffer[count++] = info; }, capacity);
+        return count;
+    }
+
+    //does not allocate: calls f(NotificationInfo&) for each notified trigger, returns the number of triggers (> 0)
+    template <typename F, typename = std::enable_if_t<std::is_invocable_v<F &, NotificationInfo &>>>
+    size_t wait(F f)
+    {
+        return waitAndCollect(f, SIZE_MAX);
+    }
+
+    //only to be called by the waiting thread (or before waiting), applies to all following waits
+    void setDelivery(Delivery delivery)
+    {
+        m_delivery = delivery;
+    }
+
+protected:
+    Signaller &signaller()
+    {
+        return m_signaller;
+    }
+
+    const Signaller &signaller() const
+    {
+        return m_signaller;
+    }
+
+    //counts a notification of the trigger, true if the waiter must be woken (see wake),
+    //false if the trigger is detached or already marked (the waiter is woken for the earlier notification)
+    bool markReady(index_t index, id_t id)
+    {
+        if (index >= MaxTriggers)
+        {
+            return false;
+        }
+        auto &counter = m_counters[index];
+        //acquire: the priority of the attachment is published with the counter
+        auto value = counter.load(std::memory_order_acquire);
+        do
+        {
+            if (tag(value) != tagOf(id))
+            {
+                return false; //detached (late trigger call)
+            }
+            if ((value & COUNT_MASK) == COUNT_MASK)
+            {
+                break; //saturated, still wake up the waiter
+            }
+        } while (!counter.compare_exchange_weak(value, value + 1, std::memory_order_acq_rel, std::memory_order_acquire));
+
+        //if the index was reattached in the meantime, the bit may be set at the wrong priority,
+        //the waiter finds a zero count there and skips it
+        auto priority = m_priorities[index].load(std::memory_order_relaxed);
+        return setReady(priority, index);
+    }
+
+    //signals the waiter unless it is awake, after markReady (once for any number of triggers)
+    void wake()
+    {
+        //seq_cst (as the update of m_readyPriorities in setReady), pairs with beginSleep:
+        //either we see the waiter blocking or it sees our ready bits
+        if (!m_waiterAwake.load(std::memory_order_seq_cst))
+        {
+            instrumentation::onSignal(this);
+            m_signaller.signal();
+        }
+    }
+
+    //the waiter announces that it blocks, false if there are notifications to collect (it must not block then)
+    //endSleep must be called after blocking
+    bool beginSleep()
+    {
+        m_waiterAwake.store(false, std::memory_order_seq_cst);
+        if (m_readyPriorities.load(std::memory_order_seq_cst) != 0)
+        {
+            m_waiterAwake.store(true, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void endSleep()
+    {
+        m_waiterAwake.store(true, std::memory_order_relaxed);
+    }
+
+private:
+    Signaller m_signaller;
+
+    IndexPool<MaxTriggers> m_indexPool;
+    std::array<TriggerInfo, MaxTriggers> m_triggerInfos;
+
+    //monotonic, to be reasonably sure we idenfified the correct trigger (modulo wraparound)
+    std::atomic<id_t> m_triggerId{1};
+    id_t m_internalId{INVALID_ID};
+    Delivery m_delivery{Delivery::ALL};
+
+    //false only while the waiter blocks in the signaller (or is about to), written by the waiter only
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> m_waiterAwake{false};
+
+    //the notification counter of a trigger holds a tag of the attached trigger (the lower 32 bits of its id,
+    //0 if detached) and the number of notifications in one word, so a notification and a detach
+    //(or a reattach with a new id) cannot be interleaved, i.e. a late notification of a detached trigger is never counted
+    static constexpr uint64_t COUNT_MASK = 0xFFFFFFFF;
+    static constexpr uint32_t SUMMARY_WORDS = (MaxTriggers + 63) / 64;
+
+    //only written by notify, attach and detach, kept apart from the trigger infos (which the waiter reads)
+    alignas(CACHE_LINE_SIZE) std::array<std::atomic<uint64_t>, MaxTriggers> m_counters{};
+    std::array<std::atomic<priority_t>, MaxTriggers> m_priorities{};
+
+    //ready bitmap with three levels: bit p of m_readyPriorities is set if priority p has notified triggers,
+    //bit w of m_readyWords[p] if m_summary[p][w] has set bits and bit i of m_summary[p][w] after the counter
+    //of trigger 64 * w + i (with priority p) was incremented, i.e. the highest notified priority and its triggers
+    //are found with a few bit scans, the waiter only reads counters of set bits
+    //
+    //notify sets the bits bottom-up, the waiter clears them top-down, i.e. a set bit always has its parent bits set
+    //(a parent bit may be set without set child bits, the waiter skips it)
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_readyPriorities{0};
+    std::array<std::atomic<uint64_t>, NUM_PRIORITIES> m_readyWords{};
+    alignas(CACHE_LINE_SIZE) std::array<std::array<std::atomic<uint64_t>, SUMMARY_WORDS>, NUM_PRIORITIES> m_summary{};
+
+    static uint32_t tagOf(id_t id)
+    {
+        return static_cast<uint32_t>(id);
+    }
+
+    static uint32_t tag(uint64_t counter)
+    {
+        return static_cast<uint32_t>(counter >> 32);
+    }
+
+    //false if the trigger is already marked (and not collected yet), its notifier sets the parent bits and wakes
+    bool setReady(priority_t priority, index_t index)
+    {
+        auto word = index / 64;
+        auto mask = uint64_t(1) << (index % 64);
+        if (m_summary[priority][word].fetch_or(mask, std::memory_order_release) & mask)
+        {
+            return false;
+        }
+        m_readyWords[priority].fetch_or(uint64_t(1) << word, std::memory_order_release);
+        m_readyPriorities.fetch_or(uint64_t(1) << priority, std::memory_order_seq_cst); //see wake
+        return true;
+    }
+
+    //ids with a zero tag are skipped, the tag 0 means detached
+    id_t generateTriggerId()
+    {
+        id_t id;
+        do
+        {
+            id = m_triggerId.fetch_add(1, std::memory_order_relaxed);
+        } while (id == INVALID_ID || tagOf(id) == 0);
+        return id;
+    }
+
+    //without a deadline (time_point::max) we wait until at least one notification is collected, otherwise 0 means timed out
+    template <typename F>
+    size_t waitAndCollect(F &&f, size_t maxCount,
+                          std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max())
+    {
+        instrumentation::onWaitBegin(this);
+        size_t count = collectNotifications(f, maxCount);
+
+        //notifications that are left (maxCount or lower priorities) are seen by the next beginSleep
+        while (count == 0)
+        {
+            if (beginSleep())
+            {
+                bool signalled = true;
+                if (deadline == std::chrono::steady_clock::time_point::max())
+                {
+                    m_signaller.wait();
+                }
+                else
+                {
+                    signalled = m_signaller.waitUntil(deadline);
+                }
+                endSleep();
+                if (!signalled)
+                {
+                    break; //timed out
+                }
+            }
+            count = collectNotifications(f, maxCount);
+        }
+        instrumentation::onWaitEnd(this);
+        return count;
+    }
+
+    //calls f for at most maxCount notified triggers, highest priority first, the others stay in the ready bitmap
+    template <typename F>
+    size_t collectNotifications(F &f, size_t maxCount)
+    {
+        size_t numCollected = 0;
+        auto priorities = m_readyPriorities.load(std::memory_order_acquire);
+        while (priorities != 0 && numCollected < maxCount)
+        {
+            auto priority = static_cast<priority_t>(63 - __builtin_clzll(priorities));
+            priorities &= ~(uint64_t(1) << priority);
+
+            numCollected += collectNotifications(priority, f, maxCount - numCollected);
+            if (numCollected > 0 && m_delivery == Delivery::HIGHEST_PRIORITY)
+            {
+                break;
+            }
+        }
+        return numCollected;
+    }
+
+    template <typename F>
+    size_t collectNotifications(priority_t priority, F &f, size_t maxCount)
+    {
+        auto priorityBit = uint64_t(1) << priority;
+        m_readyPriorities.fetch_and(~priorityBit, std::memory_order_acquire);
+        auto words = m_readyWords[priority].exchange(0, std::memory_order_acquire);
+        uint64_t remainingWords = 0;
+
+        size_t numCollected = 0;
+        while (words != 0 && numCollected < maxCount)
+        {
+            auto word = static_cast<uint32_t>(__builtin_ctzll(words));
+            words &= words - 1;
+
+            auto &summary = m_summary[priority][word];
+            auto bits = summary.exchange(0, std::memory_order_acquire);
+            while (bits != 0 && numCollected < maxCount)
+            {
+                auto index = word * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+
+                //drain all pending notifications at once, the tag stays (0 if detached concurrently)
+                auto count = m_counters[index].fetch_and(~COUNT_MASK, std::memory_order_acq_rel) & COUNT_MASK;
+                if (count > 0)
+                {
+                    auto &info = m_triggerInfos[index].notificationInfo;
+                    info.count = count;
+                    info.priority = priority;
+                    f(info);
+                    ++numCollected;
+                }
+            }
+            if (bits != 0)
+            {
+                summary.fetch_or(bits, std::memory_order_relaxed); //not visited, put them back
+                remainingWords |= uint64_t(1) << word;
+            }
+        }
+
+        remainingWords |= words;
+        if (remainingWords != 0)
+        {
+            m_readyWords[priority].fetch_or(remainingWords, std::memory_order_relaxed);
+            m_readyPriorities.fetch_or(priorityBit, std::memory_order_relaxed);
+        }
+        return numCollected;
+    }
+};
+
+} // namespace ws
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+
+//must be compiled with CP_CONTENTION_STATS (see CMakeLists.txt), otherwise all counters stay empty
+#include "instrumentation/probes.hpp"
+#include "lock.hpp"
+#include "semaphore.hpp"
+#include "lightweight_semphore.hpp"
+
+Lock lock;
+Semaphore semaphore;
+LightweightSemaphore<Semaphore> lightSemaphore;
+int64_t count{0};
+
+void work(int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        lock.lock();
+        ++count;
+        lock.unlock();
+    }
+}
+
+void consume(int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        semaphore.wait();
+        lightSemaphore.wait();
+    }
+}
+
+void produce(int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        semaphore.post();
+        lightSemaphore.post();
+    }
+}
+
+int main(int argc, char **argv)
+{
+#ifdef CP_CONTENTION_STATS
+    auto &registry = instrumentation::StatsRegistry::instance();
+    registry.setName(&lock, "lock");
+    registry.setName(&semaphore, "semaphore");
+    registry.setName(&lightSemaphore, "lightweight semaphore");
+#endif
+
+    int iterations = 100000;
+    int n = 4;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < n; ++i)
+    {
+        threads.emplace_back(work, iterations);
+        threads.emplace_back(consume, iterations);
+        threads.emplace_back(produce, iterations);
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::cout << "count " << count << std::endl;
+
+#ifdef CP_CONTENTION_STATS
+    registry.dump(std::cout);
+    registry.dump(std::cout, true);
+#else
+    std::cout << "compiled without CP_CONTENTION_STATS, no counters" << std::endl;
+#endif
+    return 0;
+}
@@ -10,6 +10,10 @@
 #include "id_aware_lock.hpp"
 #include "mutex.hpp"
 
+#if __cplusplus >= 202002L
+#include "atomic_lock.hpp"
+#endif
+
 struct NoLock
 {
     void lock() {}
@@ -132,5 +136,15 @@ int main(int argc, char **argv)
         std::cout << "IdLock test: count " << count << " mutex errors " << mutexError.load() << " time " << elapsed.count() << "ms" << std::endl;
     }
 
+#if __cplusplus >= 202002L
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        test<AtomicLock>(iterations, n);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "AtomicLock test: count " << count << " mutex errors " << mutexError.load() << " time " << elapsed.count() << "ms" << std::endl;
+    }
+#endif
+
     return 0;
 }
\ No newline at end of file
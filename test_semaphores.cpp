@@ -8,6 +8,13 @@
 #include "semaphore.hpp"
 #include "posix_semaphore.hpp"
 #include "lightweight_semphore.hpp"
+#include "autoreset_event.hpp"
+
+#if __cplusplus >= 202002L
+#include "atomic_semaphore.hpp"
+#include "atomic_autoreset_event.hpp"
+#include "std_semaphore.hpp"
+#endif
 
 using LightSemaphore = LightweightSemaphore<Semaphore>;
 using LightPosixSemaphore = LightweightSemaphore<PosixSemaphore>;
@@ -50,6 +57,48 @@ void test(int iterations = 1000000, int n = 4)
     }
 }
 
+//events and semaphores only share wait(), the waking operation is called signal() or post()
+template <typename T>
+auto wake(T &t) -> decltype(t.signal())
+{
+    t.signal();
+}
+
+template <typename T>
+auto wake(T &t) -> decltype(t.post(), void())
+{
+    t.post();
+}
+
+template <typename T>
+void pong(T &ping, T &pong, int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        ping.wait();
+        wake(pong);
+    }
+}
+
+//ping-pong between two threads, every wait blocks (or spins) until the other side woke it
+//this is the only workload that is identical for events and semaphores (events may lose redundant signals)
+template <typename T>
+void testPingPong(int iterations = 100000)
+{
+    T ping;
+    T pong;
+
+    std::thread thread(::pong<T>, std::ref(ping), std::ref(pong), iterations);
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        wake(ping);
+        pong.wait();
+    }
+
+    thread.join();
+}
+
 int main(int argc, char **argv)
 {
     int iterations = 1000000;
@@ -87,5 +136,75 @@ int main(int argc, char **argv)
         std::cout << "LightPosixSemaphore test: time " << elapsed.count() << "ms" << std::endl;
     }
 
+#if __cplusplus >= 202002L
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        test<AtomicSemaphore>(iterations, n);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "AtomicSemaphore test: time " << elapsed.count() << "ms" << std::endl;
+    }
+
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        test<StdSemaphore>(iterations, n);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "StdSemaphore test: time " << elapsed.count() << "ms" << std::endl;
+    }
+#endif
+
+    int pingPongIterations = 100000;
+
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        testPingPong<Semaphore>(pingPongIterations);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "Semaphore ping-pong: time " << elapsed.count() << "ms" << std::endl;
+    }
+
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        testPingPong<PosixSemaphore>(pingPongIterations);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "PosixSemaphore ping-pong: time " << elapsed.count() << "ms" << std::endl;
+    }
+
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        testPingPong<AutoResetEvent>(pingPongIterations);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "AutoResetEvent ping-pong: time " << elapsed.count() << "ms" << std::endl;
+    }
+
+#if __cplusplus >= 202002L
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        testPingPong<AtomicSemaphore>(pingPongIterations);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "AtomicSemaphore ping-pong: time " << elapsed.count() << "ms" << std::endl;
+    }
+
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        testPingPong<StdSemaphore>(pingPongIterations);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "StdSemaphore ping-pong: time " << elapsed.count() << "ms" << std::endl;
+    }
+
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        testPingPong<AtomicAutoResetEvent>(pingPongIterations);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "AtomicAutoResetEvent ping-pong: time " << elapsed.count() << "ms" << std::endl;
+    }
+#endif
+
     return 0;
 }
\ No newline at end of file
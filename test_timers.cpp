@@ -0,0 +1,129 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "timer.hpp"
+
+using namespace std::chrono;
+
+//connection timeout like workload: many armed timers, most of them disarmed before they expire
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? std::atoi(argv[1]) : 100000;
+    auto maxDelay = milliseconds(argc > 2 ? std::atoi(argv[2]) : 2000);
+
+    std::atomic<int> fired{0};
+    std::atomic<int> early{0};
+    std::atomic<int64_t> maxLateness{0};
+
+    std::vector<steady_clock::time_point> deadlines(n);
+    std::vector<std::unique_ptr<Timer>> timers;
+    timers.reserve(n);
+
+    for (int i = 0; i < n; ++i)
+    {
+        timers.emplace_back(new Timer([&, i] {
+            auto lateness = duration_cast<microseconds>(steady_clock::now() - deadlines[i]).count();
+            if (lateness < 0)
+            {
+                early++;
+            }
+            auto known = maxLateness.load();
+            while (lateness > known && !maxLateness.compare_exchange_weak(known, lateness))
+            {
+            }
+            fired++;
+        }));
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int64_t> delays(1, duration_cast<microseconds>(maxDelay).count());
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < n; ++i)
+    {
+        auto delay = microseconds(delays(generator));
+        deadlines[i] = steady_clock::now() + delay;
+        timers[i]->arm(delay);
+    }
+    auto armTime = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+    //most connections answer in time
+    int disarmed = 0;
+    int hasRun = 0;
+    start = steady_clock::now();
+    for (int i = 0; i < n; i += 2)
+    {
+        auto status = timers[i]->disarm();
+        disarmed += status == Timer::Status::CANCELLED ? 1 : 0;
+        hasRun += status == Timer::Status::HAS_RUN || status == Timer::Status::RUNNING ? 1 : 0;
+    }
+    auto disarmTime = duration_cast<nanoseconds>(steady_clock::now() - start).count() / (n / 2 > 0 ? n / 2 : 1);
+
+    std::this_thread::sleep_for(maxDelay + milliseconds(100));
+
+    int expected = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        expected += timers[i]->timedOut() ? 1 : 0;
+    }
+
+    std::cout << "timers " << n << " cancelled " << disarmed << " (already run " << hasRun << ") fired " << fired
+              << " (timed out " << expected << ")"
+              << " early " << early << " max lateness " << maxLateness << "us" << std::endl;
+    std::cout << "arm " << armTime / n << "ns/timer disarm " << disarmTime << "ns/timer" << std::endl;
+
+    //the pool entries are reused by new timers
+    timers.clear();
+    Timer timer([] {});
+    std::cout << "cancelled timer callback " << (timer.isValid() && timer.arm(seconds(1)) &&
+                                                  timer.disarm() == Timer::Status::CANCELLED
+                                                      ? "will not run"
+                                                      : "unexpected")
+              << std::endl;
+
+    //periodic timer, the deadlines do not drift even though each callback takes some time
+    auto period = milliseconds(10);
+    std::atomic<int> ticks{0};
+    std::atomic<int64_t> lastDrift{0};
+    auto periodicStart = steady_clock::now();
+    Timer periodic([&] {
+        auto n = ++ticks;
+        lastDrift = duration_cast<microseconds>(steady_clock::now() - (periodicStart + n * period)).count();
+        std::this_thread::sleep_for(milliseconds(2));
+    });
+    periodic.armPeriodic(period);
+    std::this_thread::sleep_for(period * 100 + period / 2);
+    periodic.disarm();
+    std::cout << "periodic timer ticks " << ticks << " (expected 100) drift of the last tick " << lastDrift << "us"
+              << std::endl;
+
+    //timers with slack share wake ups of the service
+    std::atomic<int> coalesced{0};
+    std::vector<std::unique_ptr<Timer>> slackTimers;
+    std::vector<steady_clock::time_point> fireTimes(100);
+    for (int i = 0; i < 100; ++i)
+    {
+        slackTimers.emplace_back(new Timer([&, i] {
+            fireTimes[i] = steady_clock::now();
+            coalesced++;
+        }));
+        slackTimers.back()->arm(milliseconds(10 + i), milliseconds(50));
+    }
+    std::this_thread::sleep_for(milliseconds(200));
+    std::sort(fireTimes.begin(), fireTimes.end());
+    int wakeUps = 1;
+    for (int i = 1; i < 100; ++i)
+    {
+        wakeUps += fireTimes[i] - fireTimes[i - 1] > microseconds(500) ? 1 : 0;
+    }
+    std::cout << "100 timers within 100ms with 50ms slack fired " << coalesced << " times in " << wakeUps << " wake ups"
+              << std::endl;
+
+    return early == 0 && disarmed + hasRun == (n + 1) / 2 && fired == n - disarmed ? 0 : 1;
+}
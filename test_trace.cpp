@@ -0,0 +1,102 @@
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//must be compiled with CP_TRACE (see CMakeLists.txt), otherwise nothing is recorded
+#include "instrumentation/probes.hpp"
+#include "lock.hpp"
+#include "semaphore.hpp"
+#include "autoreset_event.hpp"
+#include "condition_variable.hpp"
+
+Lock lock;
+Semaphore semaphore;
+AutoResetEvent event;
+Semaphore acknowledged;
+ConditionVariable conditionVariable;
+Lock conditionLock;
+bool done{false};
+int64_t count{0};
+
+void work(int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        lock.lock();
+        ++count;
+        lock.unlock();
+    }
+}
+
+void consume(int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        semaphore.wait();
+        event.wait();
+        acknowledged.post();
+    }
+}
+
+void produce(int iterations)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        semaphore.post();
+        event.signal();
+        acknowledged.wait(); //signals of the auto reset event would merge otherwise
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string path = argc > 1 ? argv[1] : "trace.bin";
+    int iterations = 1000;
+
+#ifdef CP_TRACE
+    instrumentation::Tracer::enable();
+#endif
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 2; ++i)
+    {
+        threads.emplace_back(work, iterations);
+    }
+    threads.emplace_back(consume, iterations);
+    threads.emplace_back(produce, iterations);
+
+    std::thread waiter([] {
+        conditionLock.lock();
+        conditionVariable.wait(conditionLock, [] { return done; });
+        conditionLock.unlock();
+    });
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    conditionLock.lock();
+    done = true;
+    conditionLock.unlock();
+    conditionVariable.notifyOne();
+    waiter.join();
+
+    std::cout << "count " << count << std::endl;
+
+#ifdef CP_TRACE
+    instrumentation::Tracer::enable(false);
+    auto &tracer = instrumentation::Tracer::instance();
+    std::cout << tracer.snapshot().size() << " records" << std::endl;
+    if (!tracer.write(path))
+    {
+        std::cout << "cannot write " << path << std::endl;
+        return 1;
+    }
+    std::cout << "trace written to " << path << ", convert it with trace_to_chrome" << std::endl;
+#else
+    std::cout << "compiled without CP_TRACE, no trace" << std::endl;
+#endif
+    return 0;
+}
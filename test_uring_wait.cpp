@@ -0,0 +1,109 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+
+#include <unistd.h>
+
+#include "uring_wait.hpp"
+
+using namespace std::chrono;
+
+constexpr int NUM_ITEMS = 10000;
+constexpr int NUM_MESSAGES = 100;
+
+constexpr uint64_t READ_DATA = 1;
+constexpr uint64_t ITEM_DATA = 2;
+
+//one thread handles pipe reads (standing in for disk I/O) and semaphore posts with a single io_uring_enter
+int main(int argc, char **argv)
+{
+    Semaphore items;
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return 1;
+    }
+
+    std::thread itemProducer([&] {
+        for (int i = 0; i < NUM_ITEMS; ++i)
+        {
+            items.post();
+        }
+    });
+    std::thread writer([&] {
+        for (int i = 0; i < NUM_MESSAGES; ++i)
+        {
+            char message = 'x';
+            if (write(fds[1], &message, 1) != 1)
+            {
+                break;
+            }
+            std::this_thread::sleep_for(microseconds(100));
+        }
+        close(fds[1]);
+    });
+
+    int numItems = 0;
+    int numMessages = 0;
+    auto start = steady_clock::now();
+    auto ring = uring::Ring::create(16);
+    if (!ring)
+    {
+        std::cout << "io_uring not available, plain futex wait" << std::endl;
+        char message;
+        while (read(fds[0], &message, 1) == 1)
+        {
+            ++numMessages;
+        }
+        while (numItems < NUM_ITEMS)
+        {
+            items.wait();
+            ++numItems;
+        }
+    }
+    else
+    {
+        std::cout << "io_uring " << (uring::futexSupported() ? "with futex wait" : "without futex wait, timeout fallback")
+                  << std::endl;
+
+        char message;
+        auto submitRead = [&] { uring::prepareRead(ring->sqe(), fds[0], &message, 1, 0, READ_DATA); };
+        uring::FutexWait itemWait(*ring, &items, ITEM_DATA);
+
+        bool reading = true;
+        submitRead();
+        while (numItems < NUM_ITEMS && itemWait.arm())
+        {
+            ++numItems;
+        }
+        while (reading || numItems < NUM_ITEMS)
+        {
+            ring->submit(1);
+            ring->forEachCompletion([&](const io_uring_cqe &cqe) {
+                if (cqe.user_data == READ_DATA)
+                {
+                    reading = cqe.res > 0;
+                    if (reading)
+                    {
+                        ++numMessages;
+                        submitRead();
+                    }
+                }
+                else if (cqe.user_data == ITEM_DATA && itemWait.complete(cqe))
+                {
+                    do
+                    {
+                        ++numItems;
+                    } while (numItems < NUM_ITEMS && itemWait.arm());
+                }
+            });
+        }
+    }
+    auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+    itemProducer.join();
+    writer.join();
+    close(fds[0]);
+    std::cout << numItems << " items and " << numMessages << " messages in " << elapsed << "ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "wait_any.hpp"
+
+using namespace std::chrono;
+
+constexpr int NUM_ITEMS = 100000;
+constexpr int NUM_CONTROLS = 1000;
+constexpr int NUM_ROUNDS = 20000;
+constexpr int NUM_PLAIN = 2;
+constexpr int NUM_ANY = 1; //another one would acquire what the first one leaves, hiding a lost wake up
+
+//NUM_PLAIN threads acquire the source with its own wait, NUM_ANY threads with waitAny together with a tick
+//semaphore they prefer, after a tick they pause until someone else acquired the source
+//every other round the tick is posted right before the source becomes available, i.e. a waitAny consumer may take
+//the wake up of the source and leave it for the tick, then it must pass the wake up on to a plain waiter
+//(otherwise nothing progresses, reported after a second instead of hanging)
+//
+//produce makes the source available once and returns when it was taken (release follows every acquisition),
+//it is called until every consumer stopped after its first acquisition beyond NUM_ROUNDS
+template <typename T>
+bool contend(const char *name, T &source, std::function<void()> plainWait, std::function<void()> release,
+             std::function<void()> produce)
+{
+    Semaphore tick;
+    std::atomic<int> total{0};
+    std::atomic<int> stopped{0};
+    std::atomic<int> ticks{0};
+    std::atomic<bool> lost{false};
+
+    auto consume = [&](bool any) {
+        while (true)
+        {
+            if (any && waitAny({&tick, &source}) == 0)
+            {
+                ++ticks;
+                auto seen = total.load();
+                auto deadline = steady_clock::now() + seconds(1);
+                while (!lost && total.load() == seen && seen < NUM_ROUNDS)
+                {
+                    if (steady_clock::now() > deadline)
+                    {
+                        lost = true; //the plain waiters sleep although the source is available
+                        break;
+                    }
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+            if (!any)
+            {
+                plainWait();
+            }
+            bool last = total.fetch_add(1) >= NUM_ROUNDS;
+            if (last)
+            {
+                ++stopped; //before release, produce sees it when it returns
+            }
+            release();
+            if (last)
+            {
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < NUM_PLAIN + NUM_ANY; ++i)
+    {
+        consumers.emplace_back(consume, i >= NUM_PLAIN);
+    }
+
+    for (int round = 0; stopped < NUM_PLAIN + NUM_ANY; ++round)
+    {
+        if (round % 2 == 0)
+        {
+            std::this_thread::sleep_for(microseconds(20)); //the consumers block meanwhile
+            tick.post();
+        }
+        produce();
+    }
+    for (auto &consumer : consumers)
+    {
+        consumer.join();
+    }
+
+    std::cout << name << ": " << total << " acquisitions by plain and waitAny waiters, " << ticks << " ticks, "
+              << (lost ? "wake ups lost" : "no wake up lost") << std::endl;
+    return !lost;
+}
+
+bool contention()
+{
+    //one post, signal or unlock at a time, it must reach a plain waiter if a waitAny consumer leaves it
+    Semaphore taken;
+
+    Semaphore items;
+    bool ok = contend(
+        "semaphore", items, [&] { items.wait(); }, [&] { taken.post(); },
+        [&] {
+            items.post();
+            taken.wait();
+        });
+
+    AutoResetEvent event;
+    ok &= contend(
+        "event", event, [&] { event.wait(); }, [&] { taken.post(); },
+        [&] {
+            event.signal();
+            taken.wait();
+        });
+
+    //passed on: the consumers keep it locked, the next round unlocks it (the lock has no owner)
+    Lock lock;
+    lock.lock();
+    ok &= contend(
+        "lock", lock, [&] { lock.lock(); }, [&] { taken.post(); },
+        [&] {
+            lock.unlock();
+            taken.wait();
+        });
+    lock.unlock();
+    return ok;
+}
+
+//one consumer blocks on a data semaphore, a control event and a lock at once (without a wait set in between)
+int main(int argc, char **argv)
+{
+    if (CP_WAIT_ANY_FORCE_FALLBACK)
+    {
+        std::cout << "futex_waitv not used, polling fallback" << std::endl;
+    }
+    else
+    {
+        std::cout << "futex_waitv " << (futex::waitvSupported() ? "supported" : "not supported, polling fallback")
+                  << std::endl;
+    }
+
+    Semaphore data;
+    AutoResetEvent control;
+    Lock lock;
+
+    //nothing is available, times out
+    auto result = waitAnyFor({&data, &control}, milliseconds(10));
+    std::cout << "timed wait: " << (result ? "acquired" : "timed out") << std::endl;
+
+    lock.lock();
+    std::thread dataProducer([&] {
+        for (int i = 0; i < NUM_ITEMS; ++i)
+        {
+            data.post();
+        }
+    });
+    std::thread controlProducer([&] {
+        for (int i = 0; i < NUM_CONTROLS; ++i)
+        {
+            control.signal();
+            std::this_thread::sleep_for(microseconds(10));
+        }
+        lock.unlock(); //held by us until now, the consumer takes it last
+    });
+
+    int items = 0;
+    int controls = 0;
+    bool locked = false;
+    auto start = steady_clock::now();
+    while (!locked)
+    {
+        switch (waitAny({&data, &control, &lock}))
+        {
+        case 0:
+            ++items;
+            break;
+        case 1:
+            ++controls;
+            break;
+        case 2:
+            locked = true;
+            break;
+        }
+    }
+    while (items < NUM_ITEMS)
+    {
+        data.wait();
+        ++items;
+    }
+    auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    lock.unlock();
+
+    dataProducer.join();
+    controlProducer.join();
+    std::cout << items << " items, " << controls << " of " << NUM_CONTROLS << " controls (coalesced), lock "
+              << (locked ? "acquired" : "not acquired") << " in " << elapsed << "ms" << std::endl;
+
+    return contention() ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "waitset_mk2/waitset.hpp"
+
+using namespace std::chrono;
+
+using FdWaitSet = ws::WaitSet<16, ws::EpollSignaller>;
+
+//the indices are handed out in attach order (0 is reserved for notify)
+constexpr ws::index_t PIPE_INDEX = 1;
+constexpr ws::index_t USER_INDEX = 2;
+
+constexpr int NUM_EVENTS = 3;
+
+void produce(int fd, ws::Trigger &trigger)
+{
+    for (int i = 0; i < NUM_EVENTS; ++i)
+    {
+        std::this_thread::sleep_for(milliseconds(50));
+        char c = 'a' + i;
+        [[maybe_unused]] auto n = write(fd, &c, 1);
+        std::this_thread::sleep_for(milliseconds(50));
+        trigger.trigger();
+    }
+}
+
+//a pipe (e.g. a socket) and an in-process trigger share one blocking point
+void reactor()
+{
+    FdWaitSet waitSet;
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return;
+    }
+
+    ws::Trigger pipeTrigger;
+    ws::Trigger userTrigger;
+    waitSet.attach(pipeTrigger, fds[0]);
+    waitSet.attach(userTrigger);
+
+    std::thread producer(produce, fds[1], std::ref(userTrigger));
+
+    int pipeEvents = 0;
+    int userEvents = 0;
+    while (pipeEvents < NUM_EVENTS || userEvents < NUM_EVENTS)
+    {
+        waitSet.wait([&](ws::NotificationInfo &info) {
+            if (info.index == PIPE_INDEX)
+            {
+                char c;
+                [[maybe_unused]] auto n = read(fds[0], &c, 1); //level triggered, read or be notified again
+                std::cout << "reactor: pipe readable, read " << c << std::endl;
+                ++pipeEvents;
+            }
+            else if (info.index == USER_INDEX)
+            {
+                std::cout << "reactor: user trigger (" << info.count << ")" << std::endl;
+                ++userEvents;
+            }
+        });
+    }
+    producer.join();
+
+    waitSet.detach(pipeTrigger);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+//the wait set nested in an outer poll loop (e.g. of another library) via its fd
+void nested()
+{
+    FdWaitSet waitSet;
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return;
+    }
+
+    ws::Trigger pipeTrigger;
+    ws::Trigger userTrigger;
+    waitSet.attach(pipeTrigger, fds[0]);
+    waitSet.attach(userTrigger);
+
+    std::thread producer(produce, fds[1], std::ref(userTrigger));
+
+    int events = 0;
+    int polls = 0;
+    while (events < 2 * NUM_EVENTS)
+    {
+        if (waitSet.beginExternalWait())
+        {
+            pollfd outer{waitSet.fd(), POLLIN, 0};
+            poll(&outer, 1, -1);
+            ++polls;
+            waitSet.endExternalWait();
+        }
+        for (auto info : waitSet.waitFor(nanoseconds(0)))
+        {
+            if (info->index == PIPE_INDEX)
+            {
+                char c;
+                [[maybe_unused]] auto n = read(fds[0], &c, 1);
+            }
+            ++events;
+        }
+    }
+    producer.join();
+    std::cout << "nested: " << events << " events in " << polls << " outer polls" << std::endl;
+
+    waitSet.detach(pipeTrigger);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+int main(int argc, char **argv)
+{
+    reactor();
+    nested();
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "waitset/waitset.hpp"
+
+constexpr int NUM_ROUNDS = 20000;
+constexpr int NUM_WORKERS = 2;
+constexpr id_t CAPACITY = 8;
+
+//must outlive the callbacks, the last one may still run when churn returns
+struct Progress
+{
+    std::atomic<int> calls{0};
+    std::atomic<int> entered{-1};  //held round whose callback runs
+    std::atomic<int> released{-1}; //held round whose token is destroyed
+};
+
+//adds a condition, notifies it and destroys its (only) token, in every other round only when the callback runs
+//(a claimer or strand holds the node then and removes it), otherwise right away (while the waiters may be about
+//to run the callback)
+int churn(WaitSet &waitSet, Progress &progress)
+{
+    int added = 0;
+    while (added < NUM_ROUNDS)
+    {
+        int round = added;
+        bool held = round % 2 == 0;
+        auto token = waitSet.add([] { return true; }, [&progress, round, held] {
+            ++progress.calls;
+            if (held)
+            {
+                progress.entered = round;
+                while (progress.released.load() < round)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        if (!token)
+        {
+            std::this_thread::yield(); //all nodes are still held by callbacks
+            continue;
+        }
+        token->notify();
+        ++added;
+
+        if (held)
+        {
+            while (progress.entered.load() < round)
+            {
+                std::this_thread::yield();
+            }
+            token.reset();
+            progress.released = round;
+        }
+    }
+    return added;
+}
+
+//all nodes except the stop condition must be removed again
+bool allReleased(WaitSet &waitSet)
+{
+    std::vector<WaitToken> tokens;
+    for (id_t i = 1; i < CAPACITY; ++i)
+    {
+        auto token = waitSet.add([] { return false; });
+        if (!token)
+        {
+            return false;
+        }
+        tokens.push_back(*token);
+    }
+    return true;
+}
+
+//the strand keeps the node alive, the last token is destroyed while it runs
+bool strands()
+{
+    auto pool = std::make_unique<ThreadPool>(NUM_WORKERS);
+    WaitSet waitSet(CAPACITY, *pool);
+    Progress progress;
+    std::atomic<bool> done{false};
+    auto stop = *waitSet.add([&] { return done.load(); });
+
+    std::thread waiter([&] {
+        bool stopped = false;
+        while (!stopped)
+        {
+            waitSet.wait([&](id_t id) { stopped = id == stop.id(); });
+        }
+    });
+
+    auto added = churn(waitSet, progress);
+    done = true;
+    stop.notify();
+    waiter.join();
+    pool.reset(); //runs the remaining strands, they remove the last nodes
+
+    bool released = allReleased(waitSet);
+    std::cout << "strands: " << progress.calls << " callbacks for " << added << " conditions, nodes "
+              << (released ? "released" : "leaked") << std::endl;
+    return released;
+}
+
+//the claimer keeps the node alive, the last token is destroyed while it runs the callback
+bool claimers()
+{
+    WaitSet waitSet(CAPACITY);
+    Progress progress;
+    std::atomic<bool> done{false};
+    auto stop = *waitSet.add([&] { return done.load(); });
+    auto stopId = stop.id();
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < NUM_WORKERS; ++w)
+    {
+        workers.emplace_back([&] {
+            bool stopped = false;
+            while (!stopped)
+            {
+                waitSet.claim([&](id_t id) {
+                    if (id == stopId)
+                    {
+                        stopped = true;
+                        stop.notify(); //stays true, the next worker stops as well
+                    }
+                });
+            }
+        });
+    }
+
+    auto added = churn(waitSet, progress);
+    done = true;
+    stop.notify();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    bool released = allReleased(waitSet);
+    std::cout << "claimers: " << progress.calls << " callbacks for " << added << " conditions, nodes "
+              << (released ? "released" : "leaked") << std::endl;
+    return released;
+}
+
+int main(int argc, char **argv)
+{
+    bool ok = strands();
+    ok &= claimers();
+    return ok ? 0 : 1;
+}
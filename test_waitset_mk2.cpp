@@ -2,6 +2,7 @@
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <vector>
 
 #include "waitset_mk2/trigger.hpp"
 #include "waitset_mk2/waitset.hpp"
@@ -35,6 +36,129 @@ void notify(std::chrono::seconds time)
     cout << "notify 2" << std::endl;
 }
 
+//subscribers attach, trigger and detach concurrently while the waiter collects notifications
+void churn()
+{
+    ws::WaitSet<16> waitSet;
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> collected{0};
+
+    std::thread waiter([&] {
+        //smaller than the number of triggers, the rest is returned by the next wait
+        ws::NotificationInfo buffer[4];
+        while (!done)
+        {
+            auto n = waitSet.wait(buffer, 4);
+            for (size_t i = 0; i < n; ++i)
+            {
+                collected += buffer[i].count;
+            }
+        }
+    });
+
+    std::vector<std::thread> subscribers;
+    for (int i = 0; i < 4; ++i)
+    {
+        subscribers.emplace_back([&] {
+            for (int j = 0; j < 100000; ++j)
+            {
+                ws::Trigger trigger;
+                if (waitSet.attach(trigger))
+                {
+                    ws::Trigger copy = trigger;
+                    trigger.trigger();
+                    waitSet.detach(trigger);
+                    copy.trigger(); //late, ignored
+                }
+            }
+        });
+    }
+
+    for (auto &subscriber : subscribers)
+    {
+        subscriber.join();
+    }
+    done = true;
+    waitSet.notify();
+    waiter.join();
+
+    cout << "churn: collected " << collected << " notifications" << std::endl;
+}
+
+//a control trigger is delivered before the data triggers that were notified earlier,
+//with Delivery::HIGHEST_PRIORITY alone and the data triggers by the next wait
+void priorities()
+{
+    ws::WaitSet<64> waitSet;
+    waitSet.setDelivery(ws::Delivery::HIGHEST_PRIORITY);
+
+    std::vector<ws::Trigger> data(32);
+    for (auto &trigger : data)
+    {
+        waitSet.attach(trigger);
+    }
+    constexpr ws::priority_t CONTROL_PRIORITY = ws::HIGHEST_PRIORITY - 1;
+    ws::Trigger control;
+    waitSet.attach(control, CONTROL_PRIORITY);
+
+    for (auto &trigger : data)
+    {
+        trigger.trigger();
+    }
+    control.trigger();
+
+    auto first = waitSet.wait();
+    auto second = waitSet.wait();
+    cout << "priorities: first wait " << first.size() << " trigger(s) of priority " << int(first[0]->priority)
+         << ", second wait " << second.size() << " trigger(s) of priority " << int(second[0]->priority) << std::endl;
+}
+
+//a publisher fanning out to many subscribers, one by one or with notifyMany (which wakes the waiter at most once)
+void fanOut(bool batched)
+{
+    constexpr int NUM_SUBSCRIBERS = 500;
+    constexpr int NUM_ROUNDS = 1000;
+    ws::WaitSet<512> waitSet;
+    std::vector<ws::Trigger> triggers(NUM_SUBSCRIBERS);
+    for (auto &trigger : triggers)
+    {
+        waitSet.attach(trigger);
+    }
+
+    std::atomic<bool> done{false};
+    uint64_t wakeups = 0;
+    std::thread waiter([&] {
+        while (!done)
+        {
+            waitSet.wait([](ws::NotificationInfo &) {});
+            ++wakeups;
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < NUM_ROUNDS; ++round)
+    {
+        if (batched)
+        {
+            waitSet.notifyMany(triggers.data(), triggers.size());
+        }
+        else
+        {
+            for (auto &trigger : triggers)
+            {
+                trigger.trigger();
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    done = true;
+    waitSet.notify();
+    waiter.join();
+
+    cout << "fan out " << (batched ? "(notifyMany)" : "(one by one)") << ": " << NUM_ROUNDS << " x "
+         << NUM_SUBSCRIBERS << " notifications in " << elapsed.count() << "us, " << wakeups << " wake ups" << std::endl;
+}
+
 int main(int argc, char **argv)
 {
     ws::Trigger t;
@@ -47,9 +171,15 @@ int main(int argc, char **argv)
     do
     {
         cout << "waiting" << endl;
-        auto wakeupReasons = w.wait();
+        //wakes up periodically for housekeeping even without notifications
+        auto wakeupReasons = w.waitFor(std::chrono::milliseconds(500));
+        if (wakeupReasons.empty())
+        {
+            cout << "timed out" << endl;
+            continue;
+        }
         wakeups++;
-        cout << "woke up " << wakeups << " due to " << wakeupReasons[0]->index << std::endl;
+        cout << "woke up " << wakeups << " due to " << wakeupReasons[0]->index << " (" << wakeupReasons[0]->count << " notifications)" << std::endl;
     } while (wakeups < 2);
 
     //ws.notify(1); //private, as intended
@@ -59,5 +189,10 @@ int main(int argc, char **argv)
     // w.detach(t);
 
     thread.join();
+
+    churn();
+    priorities();
+    fanOut(false);
+    fanOut(true);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <chrono>
+#include <atomic>
+
+#include "waitset/waitset.hpp"
+
+using namespace std::chrono;
+
+constexpr int NUM_ITEMS = 100;
+constexpr int BATCH_SIZE = 10;
+
+//a queue that is drained in batches by its callback
+struct Queue
+{
+    std::atomic<int> size{0};
+    int batches{0};
+
+    void drainBatch()
+    {
+        auto n = std::min(size.load(), BATCH_SIZE);
+        size -= n;
+        ++batches;
+    }
+};
+
+//one notify for all items, the callback takes a batch per wait
+int drain(TriggerMode mode)
+{
+    WaitSet waitSet(4);
+    Queue queue;
+    auto token = *waitSet.add([&] { return queue.size > 0; }, [&] { queue.drainBatch(); }, mode);
+
+    queue.size = NUM_ITEMS;
+    token.notify();
+
+    //edge triggered: the first wait drains one batch, the rest stays until the next notify
+    while (!waitSet.waitFor(milliseconds(10)).empty())
+    {
+    }
+    return queue.batches;
+}
+
+int main(int argc, char **argv)
+{
+    std::cout << "edge triggered: " << drain(TriggerMode::EDGE) << " batches after one notify" << std::endl;
+    std::cout << "level triggered: " << drain(TriggerMode::LEVEL) << " batches after one notify" << std::endl;
+
+    //one-shot: delivered once for several notifications, again only after rearm
+    WaitSet waitSet(4);
+    auto token = *waitSet.add([] { return true; }, TriggerMode::ONE_SHOT);
+    int delivered = 0;
+    for (int round = 0; round < 2; ++round)
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            token.notify();
+        }
+        while (!waitSet.waitFor(milliseconds(10)).empty())
+        {
+            ++delivered;
+        }
+        token.rearm();
+    }
+    std::cout << "one-shot: delivered " << delivered << " times for 10 notifications and 1 rearm" << std::endl;
+    return 0;
+}
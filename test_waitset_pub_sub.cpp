@@ -123,14 +123,11 @@ void waitForData()
 {
     while (run)
     {
-        auto ids = waitSet.wait();
+        //auto ids = waitSet.wait();
         //auto ids = waitSet.wait(myFilter);
 
         std::cout << "woke up with ids: ";
-        for (auto id : ids)
-        {
-            std::cout << id << " ";
-        }
+        waitSet.wait([](id_t id) { std::cout << id << " "; }); //no wake up set allocated
         std::cout << std::endl;
     }
 }
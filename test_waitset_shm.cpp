@@ -0,0 +1,102 @@
+#include <iostream>
+#include <chrono>
+#include <new>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "waitset_mk2/shared_waitset.hpp"
+
+using namespace std::chrono;
+
+constexpr uint32_t MAX_TRIGGERS = 16;
+constexpr int NUM_PUBLISHERS = 3;
+constexpr int NUM_NOTIFICATIONS = 10000;
+
+//everything the processes share, placed at the start of the segment
+struct Shared
+{
+    ws::SharedWaitSet<MAX_TRIGGERS> waitSet;
+    ws::SharedTrigger<MAX_TRIGGERS> triggers[NUM_PUBLISHERS];
+};
+
+//runs in a child process, maps the segment at a (generally) different address than the subscriber
+int publish(const std::string &name, int publisher)
+{
+    auto memory = ws::SharedMemory::open(name);
+    if (!memory)
+    {
+        return 1;
+    }
+    auto shared = memory->at<Shared>(0);
+    for (int i = 0; i < NUM_NOTIFICATIONS; ++i)
+    {
+        shared->triggers[publisher].trigger(*memory);
+    }
+    return 0;
+}
+
+//the subscriber waits in this process for the notifications of publisher processes
+int main(int argc, char **argv)
+{
+    auto name = "/cp_waitset_shm_" + std::to_string(getpid());
+    auto memory = ws::SharedMemory::create(name, sizeof(Shared));
+    if (!memory)
+    {
+        std::cout << "could not create shared memory " << name << std::endl;
+        return 1;
+    }
+
+    auto shared = new (memory->base()) Shared;
+    for (auto &trigger : shared->triggers)
+    {
+        shared->waitSet.attach(trigger, *memory);
+    }
+
+    for (int publisher = 0; publisher < NUM_PUBLISHERS; ++publisher)
+    {
+        if (fork() == 0)
+        {
+            _exit(publish(name, publisher));
+        }
+    }
+
+    //the notifications of a trigger are counted, i.e. wake ups combine notifications of all publishers
+    uint64_t received[NUM_PUBLISHERS + 1] = {};
+    uint64_t total = 0;
+    uint64_t wakeups = 0;
+    auto start = steady_clock::now();
+    while (total < NUM_PUBLISHERS * NUM_NOTIFICATIONS)
+    {
+        auto n = shared->waitSet.waitFor(seconds(5));
+        if (n.empty())
+        {
+            std::cout << "timed out" << std::endl;
+            break;
+        }
+        ++wakeups;
+        for (auto info : n)
+        {
+            received[info->index] += info->count;
+            total += info->count;
+        }
+    }
+    auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    for (int publisher = 0; publisher < NUM_PUBLISHERS; ++publisher)
+    {
+        int status;
+        wait(&status);
+    }
+
+    for (int publisher = 0; publisher < NUM_PUBLISHERS; ++publisher)
+    {
+        //index 0 is reserved for notify()
+        std::cout << "publisher " << publisher << ": " << received[publisher + 1] << " notifications" << std::endl;
+    }
+    std::cout << total << " notifications in " << wakeups << " wake ups (" << elapsed << "us)" << std::endl;
+
+    shared->~Shared();
+    return total == NUM_PUBLISHERS * NUM_NOTIFICATIONS ? 0 : 1;
+}
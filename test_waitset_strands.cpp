@@ -0,0 +1,106 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "waitset/waitset.hpp"
+
+using namespace std::chrono;
+
+constexpr int NUM_SUBSCRIBERS = 8;
+constexpr int NUM_MESSAGES = 20000;
+
+struct Subscriber
+{
+    std::atomic<uint64_t> pending{0};
+    std::atomic<uint64_t> processed{0};
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0}; //must stay 1, the callbacks of a subscriber form a strand
+};
+
+//the callbacks of a wait set run on a thread pool, a slow subscriber does not block the others
+int main(int argc, char **argv)
+{
+    auto pool = std::make_unique<ThreadPool>(4);
+    WaitSet waitSet(NUM_SUBSCRIBERS + 1, *pool);
+
+    std::vector<std::unique_ptr<Subscriber>> subscribers;
+    std::vector<WaitToken> tokens;
+    for (int i = 0; i < NUM_SUBSCRIBERS; ++i)
+    {
+        subscribers.emplace_back(new Subscriber);
+        auto &subscriber = *subscribers.back();
+        bool slow = i == 0;
+        auto token = waitSet.add([&] { return subscriber.pending.load() > 0; },
+                                 [&subscriber, slow] {
+                                     auto running = ++subscriber.running;
+                                     if (running > subscriber.maxRunning)
+                                     {
+                                         subscriber.maxRunning = running;
+                                     }
+                                     if (slow)
+                                     {
+                                         std::this_thread::sleep_for(milliseconds(20));
+                                     }
+                                     subscriber.processed += subscriber.pending.exchange(0);
+                                     --subscriber.running;
+                                 });
+        tokens.push_back(*token);
+    }
+
+    std::atomic<bool> done{false};
+    auto stop = *waitSet.add([&] { return done.load(); });
+
+    std::thread waiter([&] {
+        bool stopped = false;
+        while (!stopped)
+        {
+            waitSet.wait([&](id_t id) { stopped = id == stop.id(); });
+        }
+    });
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < NUM_MESSAGES; ++i)
+    {
+        auto index = i % NUM_SUBSCRIBERS;
+        subscribers[index]->pending++;
+        tokens[index].notify();
+    }
+
+    //the fast subscribers finish long before the slow one
+    uint64_t fastProcessed = 0;
+    uint64_t fastTotal = NUM_MESSAGES - NUM_MESSAGES / NUM_SUBSCRIBERS;
+    while (fastProcessed < fastTotal)
+    {
+        std::this_thread::sleep_for(microseconds(100));
+        fastProcessed = 0;
+        for (int i = 1; i < NUM_SUBSCRIBERS; ++i)
+        {
+            fastProcessed += subscribers[i]->processed;
+        }
+    }
+    auto fastElapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    while (subscribers[0]->processed < NUM_MESSAGES / NUM_SUBSCRIBERS)
+    {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    done = true;
+    stop.notify();
+    waiter.join();
+    pool.reset(); //runs the remaining callbacks, before the subscribers and the wait set are destroyed
+
+    int maxRunning = 0;
+    for (auto &subscriber : subscribers)
+    {
+        maxRunning = std::max(maxRunning, subscriber->maxRunning.load());
+    }
+    std::cout << "fast subscribers done after " << fastElapsed << "us, slow subscriber after " << elapsed << "us"
+              << std::endl;
+    std::cout << "max concurrent callbacks of one subscriber: " << maxRunning << std::endl;
+    return maxRunning == 1 ? 0 : 1;
+}
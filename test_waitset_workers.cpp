@@ -0,0 +1,110 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "waitset/waitset.hpp"
+
+using namespace std::chrono;
+
+constexpr int NUM_SUBSCRIBERS = 32;
+constexpr int NUM_WORKERS = 4;
+constexpr int NUM_PUBLISHERS = 2;
+constexpr int NUM_MESSAGES = 100000;
+
+//data of a subscriber, its callback takes all pending messages
+struct Subscriber
+{
+    std::atomic<uint64_t> pending{0};
+    std::atomic<uint64_t> processed{0};
+};
+
+//several workers claim the ready subscribers of one wait set
+int main(int argc, char **argv)
+{
+    WaitSet waitSet(NUM_SUBSCRIBERS + 1);
+
+    std::vector<std::unique_ptr<Subscriber>> subscribers;
+    std::vector<WaitToken> tokens;
+    for (int i = 0; i < NUM_SUBSCRIBERS; ++i)
+    {
+        subscribers.emplace_back(new Subscriber);
+        auto &subscriber = *subscribers.back();
+        auto token = waitSet.add([&] { return subscriber.pending.load() > 0; },
+                                 [&] { subscriber.processed += subscriber.pending.exchange(0); });
+        tokens.push_back(*token);
+    }
+
+    //stays ready once set, every worker that claims it passes it on and stops
+    std::atomic<bool> done{false};
+    auto stop = *waitSet.add([&] { return done.load(); });
+    auto stopId = stop.id();
+
+    std::atomic<uint64_t> claimed[NUM_WORKERS] = {};
+    std::vector<std::thread> workers;
+    for (int w = 0; w < NUM_WORKERS; ++w)
+    {
+        workers.emplace_back([&, w] {
+            bool stopped = false;
+            while (!stopped)
+            {
+                waitSet.claim([&](id_t id) {
+                    if (id == stopId)
+                    {
+                        stopped = true;
+                        stop.notify();
+                        return;
+                    }
+                    ++claimed[w];
+                });
+            }
+        });
+    }
+
+    auto start = steady_clock::now();
+    std::vector<std::thread> publishers;
+    for (int p = 0; p < NUM_PUBLISHERS; ++p)
+    {
+        publishers.emplace_back([&, p] {
+            for (int i = 0; i < NUM_MESSAGES; ++i)
+            {
+                auto index = (i * NUM_PUBLISHERS + p) % NUM_SUBSCRIBERS;
+                subscribers[index]->pending++;
+                tokens[index].notify();
+            }
+        });
+    }
+    for (auto &publisher : publishers)
+    {
+        publisher.join();
+    }
+
+    //wait until all messages are processed
+    uint64_t processed = 0;
+    while (processed < NUM_PUBLISHERS * NUM_MESSAGES)
+    {
+        std::this_thread::sleep_for(milliseconds(1));
+        processed = 0;
+        for (auto &subscriber : subscribers)
+        {
+            processed += subscriber->processed;
+        }
+    }
+    auto elapsed = duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+    done = true;
+    stop.notify();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    for (int w = 0; w < NUM_WORKERS; ++w)
+    {
+        std::cout << "worker " << w << " claimed " << claimed[w] << std::endl;
+    }
+    std::cout << processed << " messages processed in " << elapsed << "ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,239 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "instrumentation/trace.hpp"
+
+//converts a binary trace (see instrumentation/trace.hpp) to the Chrome trace event format
+//(open the result in chrome://tracing or https://ui.perfetto.dev)
+//
+//wait begin/end and park/unpark of the same thread and object become duration slices,
+//the time a thread held a lock (acquired until released) becomes an async slice per lock
+//(objects that are never released, e.g. semaphores, report acquisitions as instant events),
+//all other events (and unmatched begins) become instant events
+
+using instrumentation::TraceEvent;
+using instrumentation::TraceRecord;
+
+namespace
+{
+
+std::string hex(uint64_t value)
+{
+    std::ostringstream s;
+    s << "0x" << std::hex << value;
+    return s.str();
+}
+
+class Converter
+{
+public:
+    Converter(std::ostream &out, double ticksPerNs, const std::vector<TraceRecord> &records)
+        : m_out(out), m_ticksPerNs(ticksPerNs > 0.0 ? ticksPerNs : 1.0), m_startTsc(records.empty() ? 0 : records.front().tsc)
+    {
+        for (auto &record : records)
+        {
+            if (static_cast<TraceEvent>(record.event) == TraceEvent::RELEASED)
+            {
+                m_locks.insert(record.object);
+            }
+        }
+
+        m_out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    }
+
+    ~Converter()
+    {
+        m_out << "\n]}\n";
+    }
+
+    void add(const TraceRecord &record)
+    {
+        auto event = static_cast<TraceEvent>(record.event);
+        auto key = std::make_tuple(record.threadId, record.object, pairOf(event));
+
+        switch (event)
+        {
+        case TraceEvent::WAIT_BEGIN:
+        case TraceEvent::PARK:
+            m_open[key] = record.tsc;
+            return;
+        case TraceEvent::WAIT_END:
+        case TraceEvent::UNPARK:
+        {
+            auto iter = m_open.find(key);
+            if (iter == m_open.end())
+            {
+                break;
+            }
+            emit(record, event == TraceEvent::WAIT_END ? "wait" : "park", "X", iter->second,
+                 ", \"dur\": " + microseconds(record.tsc - iter->second));
+            m_open.erase(iter);
+            return;
+        }
+        case TraceEvent::ACQUIRED:
+            if (m_locks.count(record.object) == 0)
+            {
+                break;
+            }
+            emit(record, "hold", "b", record.tsc, ", \"cat\": \"hold\", \"id\": \"" + hex(record.object) + "\"");
+            m_held.insert(std::make_pair(record.threadId, record.object));
+            return;
+        case TraceEvent::RELEASED:
+        {
+            auto iter = m_held.find(std::make_pair(record.threadId, record.object));
+            if (iter == m_held.end())
+            {
+                break;
+            }
+            emit(record, "hold", "e", record.tsc, ", \"cat\": \"hold\", \"id\": \"" + hex(record.object) + "\"");
+            m_held.erase(iter);
+            return;
+        }
+        default:
+            break;
+        }
+
+        emit(record, instrumentation::toString(event), "i", record.tsc, ", \"s\": \"t\"");
+    }
+
+    //begins without end (the trace ended while waiting) become instant events
+    //(locks still held at the end of the trace remain open async slices)
+    void finish()
+    {
+        for (auto &entry : m_open)
+        {
+            TraceRecord record{entry.second, std::get<1>(entry.first), std::get<0>(entry.first), 0};
+            emit(record, std::get<2>(entry.first) == PAIR_WAIT ? "wait begin (unfinished)" : "park (unfinished)", "i",
+                 entry.second, ", \"s\": \"t\"");
+        }
+        m_open.clear();
+    }
+
+private:
+    enum Pair
+    {
+        PAIR_NONE,
+        PAIR_WAIT,
+        PAIR_PARK
+    };
+
+    std::ostream &m_out;
+    double m_ticksPerNs;
+    uint64_t m_startTsc;
+    bool m_first{true};
+
+    std::set<uint64_t> m_locks; //objects with release events
+
+    std::map<std::tuple<uint32_t, uint64_t, Pair>, uint64_t> m_open;
+    std::set<std::pair<uint32_t, uint64_t>> m_held; //(thread, lock) currently held
+
+    static Pair pairOf(TraceEvent event)
+    {
+        switch (event)
+        {
+        case TraceEvent::WAIT_BEGIN:
+        case TraceEvent::WAIT_END:
+            return PAIR_WAIT;
+        case TraceEvent::PARK:
+        case TraceEvent::UNPARK:
+            return PAIR_PARK;
+        default:
+            return PAIR_NONE;
+        }
+    }
+
+    std::string microseconds(uint64_t ticks) const
+    {
+        std::ostringstream s;
+        s << std::fixed << std::setprecision(3) << double(ticks) / m_ticksPerNs / 1000.0;
+        return s.str();
+    }
+
+    void emit(const TraceRecord &record, const std::string &name, const char *phase, uint64_t tsc, const std::string &extra)
+    {
+        m_out << (m_first ? "\n" : ",\n") << "  {\"name\": \"" << name << "\", \"ph\": \"" << phase
+              << "\", \"ts\": " << microseconds(tsc - m_startTsc) << ", \"pid\": 1, \"tid\": " << record.threadId
+              << extra << ", \"args\": {\"object\": \"" << hex(record.object) << "\"}}";
+        m_first = false;
+    }
+};
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " <trace file> [<output json>]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    char magic[sizeof(instrumentation::Tracer::MAGIC)];
+    double ticksPerNs{1.0};
+    uint64_t count{0};
+
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char *>(&ticksPerNs), sizeof(ticksPerNs));
+    in.read(reinterpret_cast<char *>(&count), sizeof(count));
+    if (!in || std::memcmp(magic, instrumentation::Tracer::MAGIC, sizeof(magic)) != 0)
+    {
+        std::cerr << argv[1] << " is not a trace file" << std::endl;
+        return 1;
+    }
+
+    //the count comes from the file, check it before allocating (a corrupt file must not allocate huge amounts)
+    auto begin = in.tellg();
+    in.seekg(0, std::ios::end);
+    auto available = static_cast<uint64_t>(in.tellg() - begin);
+    in.seekg(begin);
+    if (count > available / sizeof(TraceRecord))
+    {
+        std::cerr << argv[1] << " is truncated" << std::endl;
+        return 1;
+    }
+
+    std::vector<TraceRecord> records(count);
+    in.read(reinterpret_cast<char *>(records.data()), static_cast<std::streamsize>(count * sizeof(TraceRecord)));
+    if (!in)
+    {
+        std::cerr << argv[1] << " is truncated" << std::endl;
+        return 1;
+    }
+
+    std::ofstream file;
+    if (argc > 2)
+    {
+        file.open(argv[2]);
+        if (!file)
+        {
+            std::cerr << "cannot write " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &out = argc > 2 ? file : std::cout;
+
+    {
+        Converter converter(out, ticksPerNs, records);
+        for (auto &record : records)
+        {
+            converter.add(record);
+        }
+        converter.finish();
+    }
+
+    if (argc > 2)
+    {
+        std::cerr << count << " records written to " << argv[2] << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,330 @@
+#include <atomic>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "benchmark/compare.hpp"
+#include "benchmark/options.hpp"
+#include "benchmark/perf_counters.hpp"
+#include "benchmark/report.hpp"
+#include "benchmark/topology.hpp"
+#include "benchmark/tsc.hpp"
+#include "benchmark/workloads.hpp"
+
+#include "semaphore.hpp"
+#include "lightweight_semphore.hpp"
+#include "autoreset_event.hpp"
+#include "condition_variable.hpp"
+#include "lock.hpp"
+#include "waitset/waitset.hpp"
+
+//measures the time from the wake up call (post, signal, notify) until the blocked thread runs again
+//
+//the waker waits (spinning, not via the primitive) until the waiter is about to block and then
+//  spin mode: wakes it immediately, i.e. the waiter is typically still in the fast path or spinning
+//  park mode: delays the wake up by --park-delay, i.e. the waiter is parked in the kernel
+//both sides take a TSC timestamp, the difference is recorded (only the measured direction uses the primitive)
+
+//adapts the primitives to a common wait()/wake() interface
+template <typename SemaphoreType>
+struct SemaphoreChannel
+{
+    SemaphoreType semaphore;
+
+    void wait()
+    {
+        semaphore.wait();
+    }
+
+    void wake()
+    {
+        semaphore.post();
+    }
+};
+
+struct EventChannel
+{
+    AutoResetEvent event;
+
+    void wait()
+    {
+        event.wait();
+    }
+
+    void wake()
+    {
+        event.signal();
+    }
+};
+
+struct ConditionVariableChannel
+{
+    Lock lock;
+    ConditionVariable conditionVariable;
+    bool ready{false}; //protected by lock
+
+    void wait()
+    {
+        lock.lock();
+        conditionVariable.wait(lock, [this]() { return ready; });
+        ready = false;
+        lock.unlock();
+    }
+
+    void wake()
+    {
+        lock.lock();
+        ready = true;
+        lock.unlock();
+        conditionVariable.notifyOne();
+    }
+};
+
+struct WaitSetChannel
+{
+    WaitSet waitSet{1};
+    std::atomic<bool> ready{false};
+    std::optional<WaitToken> token;
+
+    WaitSetChannel()
+    {
+        token = waitSet.add([this]() { return ready.load(); });
+    }
+
+    void wait()
+    {
+        waitSet.wait();
+        ready.store(false);
+    }
+
+    void wake()
+    {
+        ready.store(true);
+        token->notify();
+    }
+};
+
+enum class Mode
+{
+    SPIN,
+    PARK
+};
+
+struct WakeupOptions : public bench::Options
+{
+    std::vector<bench::Placement> placements{bench::Placement::UNPINNED, bench::Placement::SIBLING,
+                                             bench::Placement::SAME_SOCKET, bench::Placement::CROSS_SOCKET};
+    std::vector<Mode> modes{Mode::SPIN, Mode::PARK};
+    uint64_t parkDelayUs{50};
+
+    WakeupOptions()
+    {
+        iterations = 10000;
+    }
+
+protected:
+    bool parseExtension(const std::string &key, const std::string &value) override
+    {
+        if (key == "--placement")
+        {
+            placements.clear();
+            for (auto &name : split(value))
+            {
+                if (name == "unpinned")
+                    placements.push_back(bench::Placement::UNPINNED);
+                else if (name == "sibling")
+                    placements.push_back(bench::Placement::SIBLING);
+                else if (name == "socket")
+                    placements.push_back(bench::Placement::SAME_SOCKET);
+                else if (name == "cross")
+                    placements.push_back(bench::Placement::CROSS_SOCKET);
+                else
+                    return false;
+            }
+            return !placements.empty();
+        }
+        if (key == "--mode")
+        {
+            modes.clear();
+            for (auto &name : split(value))
+            {
+                if (name == "spin")
+                    modes.push_back(Mode::SPIN);
+                else if (name == "park")
+                    modes.push_back(Mode::PARK);
+                else
+                    return false;
+            }
+            return !modes.empty();
+        }
+        if (key == "--park-delay")
+        {
+            return parseNumber(value, parkDelayUs);
+        }
+        return false;
+    }
+
+private:
+    static std::vector<std::string> split(const std::string &value)
+    {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while (start <= value.size())
+        {
+            auto end = value.find(',', start);
+            end = end == std::string::npos ? value.size() : end;
+            parts.push_back(value.substr(start, end - start));
+            start = end + 1;
+        }
+        return parts;
+    }
+};
+
+template <typename Channel>
+bench::Run runPingPong(std::optional<std::pair<int, int>> cpus, Mode mode, uint64_t iterations, uint64_t parkDelayUs)
+{
+    Channel channel;
+    std::atomic<uint64_t> wakeTimestamp{0};
+    std::atomic<bool> waiting{false};
+    bench::Histogram<> latency;
+
+    std::thread waiter([&]() {
+        if (cpus.has_value())
+        {
+            bench::Topology::pin(cpus->second);
+        }
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            waiting.store(true, std::memory_order_release);
+            channel.wait();
+            auto woken = bench::Tsc::now();
+            auto woke = wakeTimestamp.load(std::memory_order_acquire);
+            //unsynchronized TSCs (should not happen on modern hardware) could produce negative differences
+            latency.record(woken > woke ? bench::Tsc::toNs(woken - woke) : 0);
+        }
+    });
+
+    cpu_set_t original;
+    pthread_getaffinity_np(pthread_self(), sizeof(original), &original);
+    if (cpus.has_value())
+    {
+        bench::Topology::pin(cpus->first);
+    }
+
+    uint64_t delayTicks = static_cast<uint64_t>(double(parkDelayUs) * 1000.0 * bench::Tsc::ticksPerNs());
+
+    auto &counters = bench::PerfCounters::instance();
+    counters.start();
+    auto start = bench::now();
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        //not part of the measurement, yielding keeps this working if both threads share a cpu
+        while (!waiting.exchange(false, std::memory_order_acq_rel))
+        {
+            std::this_thread::yield();
+        }
+
+        if (mode == Mode::PARK)
+        {
+            //yield instead of sleeping, the waker must not be parked itself when the delay ends
+            //(but must not starve the waiter if both share a cpu)
+            auto until = bench::Tsc::now() + delayTicks;
+            while (bench::Tsc::now() < until)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        wakeTimestamp.store(bench::Tsc::now(), std::memory_order_seq_cst);
+        channel.wake();
+    }
+
+    waiter.join();
+    counters.stop();
+
+    bench::Run run;
+    run.durationNs = bench::now() - start;
+    run.counters = counters.read();
+    run.operations = iterations;
+    run.latency = latency;
+
+    //unpin the main thread again for the next run
+    pthread_setaffinity_np(pthread_self(), sizeof(original), &original);
+    return run;
+}
+
+template <typename Channel>
+void runAll(bench::Report &report, const std::string &primitive, const WakeupOptions &options, const bench::Topology &topology)
+{
+    if (!options.selected(primitive))
+    {
+        return;
+    }
+
+    for (auto placement : options.placements)
+    {
+        std::optional<std::pair<int, int>> cpus;
+        if (placement != bench::Placement::UNPINNED)
+        {
+            cpus = topology.findPair(placement);
+            if (!cpus.has_value())
+            {
+                continue; //not available on this machine
+            }
+        }
+
+        for (auto mode : options.modes)
+        {
+            std::string workload = std::string(mode == Mode::SPIN ? "spin/" : "park/") + bench::toString(placement);
+            report.add(bench::measure(primitive, workload, options, 2, 0, [&]() {
+                return runPingPong<Channel>(cpus, mode, options.iterations, options.parkDelayUs);
+            }));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    WakeupOptions options;
+    if (!options.parse(argc, argv))
+    {
+        std::cerr << "  --placement=unpinned,sibling,socket,cross thread placements\n"
+                  << "  --mode=spin,park       wake immediately and/or after the waiter parked\n"
+                  << "  --park-delay=US        delay before waking in park mode (microseconds)\n";
+        return 1;
+    }
+
+    bench::Topology topology;
+    for (auto placement : options.placements)
+    {
+        if (placement != bench::Placement::UNPINNED && !topology.findPair(placement).has_value())
+        {
+            std::cerr << "placement " << bench::toString(placement) << " not available on this machine, skipped" << std::endl;
+        }
+    }
+
+    if (options.perf && !bench::PerfCounters::instance().open())
+    {
+        std::cerr << "no performance counters available (check /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+    }
+
+    bench::Tsc::ticksPerNs(); //calibrate before measuring
+
+    bench::Report report(options.format);
+
+    runAll<SemaphoreChannel<Semaphore>>(report, "Semaphore", options, topology);
+    runAll<SemaphoreChannel<LightweightSemaphore<Semaphore>>>(report, "LightweightSemaphore", options, topology);
+    runAll<EventChannel>(report, "AutoResetEvent", options, topology);
+    runAll<ConditionVariableChannel>(report, "ConditionVariable", options, topology);
+    runAll<WaitSetChannel>(report, "WaitSet", options, topology);
+
+    if (!options.compare.empty())
+    {
+        bench::printComparison(report.results(), options.compare[0], options.compare[1]);
+    }
+
+    return 0;
+}